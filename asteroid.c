@@ -1,220 +1,204 @@
-#ifndef ASTEROID_H_
-#define ASTEROID_H_
-
 #include "asteroid.h"
+#include "config.h"
 #include "display.h"
-#include "time.h"
+#include "entity.h"
+#include "logger.h"
+#include "random.h"
+#include "render.h"
+#include "stateHash.h"
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
-
-#define INIT_ST_MSG "asteroid_init_st\n"
-#define PLAY_ST_MSG "asteroid_play_st\n"
-#define ERROR_ST_MSG "asteroid_error_st\n"
 
-#define MAX_ASTEROID_COUNT 25
 #define LARGE_ASTEROID_RADIUS 24
 #define MEDIUM_ASTEROID_RADIUS 12
 #define SMALL_ASTEROID_RADIUS 6
-#define VELOCITY_VARIANCE 8
+// Asteroid speeds along each axis, in pixels per second. A new asteroid
+// moves at least MIN_SPEED and less than MIN_SPEED + SPEED_RANGE, and each
+// fragment's speed differs from its parent's by up to SPEED_VARIANCE / 2.
+// Velocities are stored as whole pixels per tick.
+#define MIN_SPEED 10
+#define SPEED_RANGE 40
+#define SPEED_VARIANCE 80
+#define PIXELS_PER_TICK(perSecond) ((int)(CONFIG_PER_TICK(perSecond) + 0.5))
+#define MIN_VELOCITY PIXELS_PER_TICK(MIN_SPEED)
+#define VELOCITY_RANGE PIXELS_PER_TICK(SPEED_RANGE)
+#define VELOCITY_VARIANCE PIXELS_PER_TICK(SPEED_VARIANCE)
+#define ASTEROID_FRAGMENT_COUNT 2
 #define DISPLAY_MID_X DISPLAY_WIDTH / 2
 #define DISPLAY_MID_Y DISPLAY_HEIGHT / 2
 
-static struct Asteroid *headAsteroid;
-static struct Asteroid *tailAsteroid;
-static uint8_t asteroidCount;
 static bool enabled;
 static uint16_t counter;
+// Seed of the level being played, and how many asteroids have split since it
+// started. Each split draws from its own stream derived from the two, so
+// replaying the same hits gives the same fragments.
+static uint32_t levelSeed;
+static uint32_t splitCount;
+// Scratch for asteroid_generateAsteroids, which adds at most UINT8_MAX.
+static int16_t newX[UINT8_MAX];
+static int16_t newY[UINT8_MAX];
+static int8_t newXVelocity[UINT8_MAX];
+static int8_t newYVelocity[UINT8_MAX];
 
-struct Asteroid {
+// A hit asteroid whose fragments have not been added yet: where the parent
+// was, how it moved and the fragments' radius.
+typedef struct {
   int16_t x;
   int16_t y;
   int8_t xVelocity;
   int8_t yVelocity;
-  uint8_t radius;
-  bool collision;
-  struct Asteroid *previousAsteroid;
-  struct Asteroid *nextAsteroid;
-};
+  uint8_t fragmentRadius;
+} split_t;
+
+// Splits queued by asteroid_collision this tick. Every queued parent has
+// been killed, so there is never more than one per asteroid.
+static split_t splits[MAX_ASTEROID_COUNT];
+static uint16_t splitQueueCount;
+
+// Every asteroid lives in this store (see entity.h): adding one appends, and
+// destroying one kills it, which takes it out at the tick's flush while the
+// survivors keep their order. None of it touches the heap.
+ENTITY_STORE(asteroids, MAX_ASTEROID_COUNT);
 
 static enum asteroidControl_st_t { init_st, play_st } currentState;
 
 // it adds an asteroid. What's there to explain?
-struct Asteroid *asteroid_addAsteroid(int16_t myX, int16_t myY,
-                                      int8_t myXVelocity, int8_t myYVelocity,
-                                      uint8_t myRadius) {
-  struct Asteroid *newAsteroid =
-      (struct Asteroid *)malloc(sizeof(struct Asteroid));
-
-  if (newAsteroid) {
-    newAsteroid->x = myX;
-    newAsteroid->y = myY;
-    newAsteroid->xVelocity = myXVelocity;
-    newAsteroid->yVelocity = myYVelocity;
-    newAsteroid->radius = myRadius;
-    newAsteroid->collision = false;
-    newAsteroid->nextAsteroid = NULL;
-  }
-  if (asteroidCount) {
-    tailAsteroid->nextAsteroid = newAsteroid;
-    newAsteroid->previousAsteroid = tailAsteroid;
-    tailAsteroid = newAsteroid;
-  } else {
-    headAsteroid = newAsteroid;
-    tailAsteroid = newAsteroid;
-    newAsteroid->previousAsteroid = NULL;
-  }
-  ++asteroidCount;
-  return newAsteroid;
+// Returns false without adding anything when storage is full.
+bool asteroid_addAsteroid(int16_t myX, int16_t myY, int8_t myXVelocity,
+                          int8_t myYVelocity, uint8_t myRadius) {
+  return entity_create(&asteroids, myX, myY, myXVelocity, myYVelocity,
+                       myRadius) != ENTITY_HANDLE_NONE;
 }
 
-void asteroid_generateAsteroids(uint8_t num) {
-  srand(0);
-  for (int i = 0; i < num; i++) {
-    uint8_t xVel = 1 + rand() % (VELOCITY_VARIANCE / 2);
-    if (rand() % 2) {
-      xVel = -xVel;
-    }
-    uint8_t yVel = 1 + rand() % (VELOCITY_VARIANCE / 2);
-    if (rand() % 2) {
-      yVel = -yVel;
-    }
-    if (rand() % 2) {
-      uint16_t xPos = rand() % DISPLAY_WIDTH;
-      asteroid_addAsteroid(xPos, 0, xVel, yVel, LARGE_ASTEROID_RADIUS);
+// Draw every position and velocity in batches, then put each asteroid on the
+// top or the left edge.
+void asteroid_generateAsteroids(uint8_t num, uint32_t seed) {
+  random_t random;
+  random_seed(&random, seed);
+  levelSeed = seed;
+  splitCount = 0;
+  random_fillPositions(&random, newX, newY, num, DISPLAY_WIDTH,
+                       DISPLAY_HEIGHT);
+  random_fillVelocities(&random, newXVelocity, num, MIN_VELOCITY,
+                        VELOCITY_RANGE);
+  random_fillVelocities(&random, newYVelocity, num, MIN_VELOCITY,
+                        VELOCITY_RANGE);
+  for (uint8_t i = 0; i < num; i++) {
+    if (random_below(&random, 2)) {
+      newY[i] = 0;
     } else {
-      uint16_t yPos = rand() % DISPLAY_WIDTH;
-      asteroid_addAsteroid(0, yPos, xVel, yVel, LARGE_ASTEROID_RADIUS);
+      newX[i] = 0;
     }
+    asteroid_addAsteroid(newX[i], newY[i], newXVelocity[i], newYVelocity[i],
+                         LARGE_ASTEROID_RADIUS);
   }
 }
 
-void asteroid_drawAsteroid(struct Asteroid *asteroid) {
-  display_drawCircle(asteroid->x, asteroid->y, asteroid->radius, DISPLAY_WHITE);
-}
-
-void asteroid_eraseAsteroid(struct Asteroid *asteroid) {
-  display_drawCircle(asteroid->x, asteroid->y, asteroid->radius, DISPLAY_BLACK);
-}
-
-void asteroid_destroyAsteroid(struct Asteroid *asteroid) {
-  if (asteroid && asteroidCount > 0) {
-    asteroid_eraseAsteroid(asteroid);
-    struct Asteroid *previous = asteroid->previousAsteroid;
-    struct Asteroid *next = asteroid->nextAsteroid;
-    if (next != NULL) {
-      next->previousAsteroid = previous;
-    }
-    if (previous != NULL) {
-      previous->nextAsteroid = next;
-    }
-    if (asteroid == headAsteroid) {
-      headAsteroid = next;
-    }
-    if (asteroid == tailAsteroid) {
-      tailAsteroid = previous;
-    }
-    free(asteroid);
-    --asteroidCount;
-  }
+// Submit the asteroid to this frame's render list, alpha of the way through
+// its last move. Asteroids that stop being drawn are erased by the render
+// stage, so there is no erase function.
+void asteroid_drawAsteroid(uint16_t index, uint16_t alpha) {
+  render_circle(
+      render_lerp(asteroids.previousX[index], asteroids.x[index], alpha),
+      render_lerp(asteroids.previousY[index], asteroids.y[index], alpha),
+      asteroids.radius[index]);
 }
 
+// Remove every asteroid. The render stage erases them on the next frame.
 void asteroid_eraseAll() {
-  if (asteroidCount != 0) {
-    struct Asteroid *asteroid = headAsteroid;
-    while (asteroid != NULL) {
-      struct Asteroid *temp = asteroid->nextAsteroid;
-      asteroid_eraseAsteroid(asteroid);
-      asteroid_destroyAsteroid(asteroid);
-      asteroid = temp;
-      --asteroidCount;
-    }
-  }
+  entity_clear(&asteroids);
+  splitQueueCount = 0;
 }
 
 void asteroid_enable() {
   enabled = true;
-  printf("we got this far\n");
+  LOG_DEBUG(logger_asteroidEnabled, 0, 0);
 }
 
 void asteroid_disable() {
   asteroid_eraseAll();
   enabled = false;
-  printf("now we're this far\n");
+  LOG_DEBUG(logger_asteroidDisabled, 0, 0);
 }
 
 // when laser or ship is detected within asteroid radius, asteroid
-// will depending on size split into two smaller asteroids or be destroyed
-void asteroid_collision(struct Asteroid *asteroid) {
-  srand(time(0));
-  asteroid->collision = true;
-  asteroid_eraseAsteroid(asteroid);
-  if (asteroid->radius >= LARGE_ASTEROID_RADIUS) {
-    asteroid_addAsteroid(asteroid->x, asteroid->y,
-                         asteroid->xVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         asteroid->yVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         MEDIUM_ASTEROID_RADIUS);
-    asteroid_addAsteroid(asteroid->x, asteroid->y,
-                         asteroid->xVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         asteroid->yVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         MEDIUM_ASTEROID_RADIUS);
-    asteroid_destroyAsteroid(asteroid);
-  } else if (asteroid->radius >= MEDIUM_ASTEROID_RADIUS) {
-    asteroid_addAsteroid(asteroid->x, asteroid->y,
-                         asteroid->xVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         asteroid->yVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         SMALL_ASTEROID_RADIUS);
-    asteroid_addAsteroid(asteroid->x, asteroid->y,
-                         asteroid->xVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         asteroid->yVelocity + (rand() % VELOCITY_VARIANCE -
-                                                VELOCITY_VARIANCE / 2),
-                         SMALL_ASTEROID_RADIUS);
-    asteroid_destroyAsteroid(asteroid);
+// will depending on size split into two smaller asteroids or be destroyed.
+// The parent is killed and its split queued; asteroid_addFragments adds the
+// fragments once the kills are flushed, so one of them can always take the
+// parent's slot.
+void asteroid_collision(entity_handle_t asteroid) {
+  uint16_t index = entity_getIndex(&asteroids, asteroid);
+  if (index == ENTITY_NONE) {
+    return;
+  }
+  uint8_t radius = asteroids.radius[index];
+  split_t split = {.x = asteroids.x[index],
+                   .y = asteroids.y[index],
+                   .xVelocity = asteroids.xVelocity[index],
+                   .yVelocity = asteroids.yVelocity[index]};
+  entity_kill(&asteroids, asteroid);
+
+  if (radius >= LARGE_ASTEROID_RADIUS) {
+    split.fragmentRadius = MEDIUM_ASTEROID_RADIUS;
+  } else if (radius >= MEDIUM_ASTEROID_RADIUS) {
+    split.fragmentRadius = SMALL_ASTEROID_RADIUS;
   } else {
-    asteroid_destroyAsteroid(asteroid);
+    return;
   }
+  splits[splitQueueCount++] = split;
 }
 
-void asteroid_moveAsteroid(struct Asteroid *asteroid) {
-  if (asteroid->x <= (-1 * asteroid->radius)) {
-    asteroid->x = DISPLAY_WIDTH;
-  } else if (asteroid->x >= (DISPLAY_WIDTH + asteroid->radius)) {
-    asteroid->x = 0;
-  } else {
-    asteroid->x = asteroid->x + asteroid->xVelocity;
+// Append the fragments of every queued split, in the order the parents were
+// hit. Call after entity_flush. A fragment that still does not fit is
+// dropped.
+static void asteroid_addFragments() {
+  for (uint16_t s = 0; s < splitQueueCount; s++) {
+    const split_t *split = &splits[s];
+    random_t random;
+    random_seed(&random, random_deriveSeed(levelSeed, splitCount++));
+    for (uint8_t i = 0; i < ASTEROID_FRAGMENT_COUNT; i++) {
+      int8_t xChange = random_below(&random, VELOCITY_VARIANCE);
+      int8_t yChange = random_below(&random, VELOCITY_VARIANCE);
+      asteroid_addAsteroid(
+          split->x, split->y,
+          split->xVelocity + xChange - VELOCITY_VARIANCE / 2,
+          split->yVelocity + yChange - VELOCITY_VARIANCE / 2,
+          split->fragmentRadius);
+    }
   }
-  if (asteroid->y <= (-1 * asteroid->radius)) {
-    asteroid->y = DISPLAY_HEIGHT;
-  } else if (asteroid->y >= (DISPLAY_HEIGHT + asteroid->radius)) {
-    asteroid->y = 0;
-  } else {
-    asteroid->y = asteroid->y + asteroid->yVelocity;
+  splitQueueCount = 0;
+}
+
+void asteroid_markCollision(entity_handle_t asteroid) {
+  uint16_t index = entity_getIndex(&asteroids, asteroid);
+  if (index != ENTITY_NONE) {
+    asteroids.flags[index] |= ENTITY_FLAG_COLLISION;
   }
 }
 
+void asteroid_moveAll() { entity_moveAll(&asteroids); }
+
 // starts asteroid state machine, it doesn't really have that much to do
 void asteroid_init() {
-  asteroidCount = 0;
+  currentState = init_st;
+  counter = 0;
+  levelSeed = CONFIG_RANDOM_SEED;
+  splitCount = 0;
+  splitQueueCount = 0;
+  entity_init(&asteroids);
   enabled = false;
 }
 
 void asteroid_debugState() {
   switch (currentState) {
   case init_st:
-    printf(INIT_ST_MSG);
+    LOG_DEBUG(logger_asteroidInitState, 0, 0);
     break;
   case play_st:
-    printf(PLAY_ST_MSG);
+    LOG_DEBUG(logger_asteroidPlayState, 0, 0);
     break;
   default:
-    printf(ERROR_ST_MSG);
+    LOG_ERROR(logger_errorState, currentState, 0);
     break;
   }
 }
@@ -224,7 +208,7 @@ void asteroid_testProgram(uint16_t *counter) {
     // struct Asteroid *asteroid = asteroid_addAsteroid(DISPLAY_MID_X,
     // DISPLAY_MID_Y, 3, 3, 24);
   } else if (*counter >= 20) {
-    headAsteroid->collision = true;
+    asteroid_markCollision(asteroid_getHandle(0));
     *counter = 1;
   }
 }
@@ -238,7 +222,6 @@ void asteroid_tick() {
   switch (currentState) {
   case init_st:
     if (!enabled) {
-      asteroidCount = 0;
       currentState = init_st;
     } else {
       counter = 0;
@@ -251,17 +234,19 @@ void asteroid_tick() {
       currentState = init_st;
     } else {
       asteroid_testProgram(&counter);
-      struct Asteroid *asteroid = headAsteroid;
-      while (asteroid != NULL && headAsteroid != NULL) {
-        if (asteroid->collision) {
-          asteroid_collision(asteroid);
-        } else {
-          asteroid_eraseAsteroid(asteroid);
-          asteroid_moveAsteroid(asteroid);
-          asteroid_drawAsteroid(asteroid);
+      // Kill everything that was hit, take the parents out in one pass, then
+      // append the fragments where they were. Fragments are added after the
+      // loop, so they are not split again this tick. This stays on one
+      // thread: splits are numbered in a fixed order, which keeps the result
+      // the same for any thread count.
+      for (uint16_t i = 0; i < asteroids.count; i++) {
+        if (asteroids.flags[i] & ENTITY_FLAG_COLLISION) {
+          asteroid_collision(entity_getHandle(&asteroids, i));
         }
-        asteroid = asteroid->nextAsteroid;
       }
+      entity_flush(&asteroids);
+      asteroid_addFragments();
+      asteroid_moveAll();
       counter++;
       currentState = play_st;
     }
@@ -273,13 +258,34 @@ void asteroid_tick() {
   // means nothing in the end
 }
 
-uint8_t asteroid_getCount() { return asteroidCount; }
+// Submit every asteroid in play, interpolated alpha of the way through the
+// last tick's move.
+void asteroid_draw(uint16_t alpha) {
+  for (uint16_t i = 0; i < asteroids.count; i++) {
+    asteroid_drawAsteroid(i, alpha);
+  }
+}
+
+uint16_t asteroid_getCount() { return asteroids.count; }
 
-struct Asteroid *asteroid_getHeadAsteroid() {
-  return headAsteroid;
+uint16_t asteroid_getHighWaterMark() { return asteroids.highWaterMark; }
+
+uint32_t asteroid_getFailedAcquireCount() {
+  return asteroids.failedCreateCount;
+}
+
+entity_handle_t asteroid_getHandle(uint16_t index) {
+  return entity_getHandle(&asteroids, index);
 }
 
-struct Asteroid *asteroid_getTailAsteroid() {
-  return tailAsteroid;
+entity_view_t asteroid_getView() { return entity_getView(&asteroids); }
+
+// Fold the asteroid state into hash. Only slots in play count.
+uint32_t asteroid_hashState(uint32_t hash) {
+  hash = stateHash_add(hash, &currentState, sizeof currentState);
+  hash = stateHash_add(hash, &enabled, sizeof enabled);
+  hash = stateHash_add(hash, &counter, sizeof counter);
+  hash = stateHash_add(hash, &levelSeed, sizeof levelSeed);
+  hash = stateHash_add(hash, &splitCount, sizeof splitCount);
+  return entity_hashState(&asteroids, hash);
 }
-#endif /* ASTEROID_H_ */
@@ -1,25 +1,28 @@
 #ifndef ASTEROID_H_
 #define ASTEROID_H_
 
+#include "entity.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <display.h>
 
-struct Asteroid {
-  int16_t x;
-  int16_t y;
-  int8_t xVelocity;
-  int8_t yVelocity;
-  uint8_t radius;
-  bool collision;
-  struct Asteroid *previousAsteroid;
-  struct Asteroid *nextAsteroid;
-};
+// Number of asteroids that can be in play at once. Storage for all of them is
+// reserved up front; see asteroid_addAsteroid for what happens past the limit.
+// Host stress builds raise this (it can go up to UINT16_MAX).
+#ifndef MAX_ASTEROID_COUNT
+#define MAX_ASTEROID_COUNT 25
+#endif
 
 // it adds an asteroid. What's there to explain?
-struct Asteroid* asteroid_addAsteroid(int16_t myX, int16_t myY, int8_t myXVelocity, int8_t myYVelocity, uint8_t myRadius);
+// Storage is fixed at MAX_ASTEROID_COUNT; when it is full nothing is added
+// and false is returned.
+bool asteroid_addAsteroid(int16_t myX, int16_t myY, int8_t myXVelocity,
+                          int8_t myYVelocity, uint8_t myRadius);
 
-void asteroid_generateAsteroids(uint8_t num);
+// Add num large asteroids at the top and left edges of the screen, placed
+// and aimed by the random stream for seed (see random.h). Asteroids that
+// split from then on draw from streams derived from the same seed.
+void asteroid_generateAsteroids(uint8_t num, uint32_t seed);
 
 void asteroid_enable();
 
@@ -28,20 +31,50 @@ void asteroid_disable();
 // when laser or ship is detected within asteroid radius, asteroid
 // will depending on size split into two smaller asteroids or be destroyed.
 // Or a UFO if we decide to include those, Tier 3 goal on our Kickstarter
-void asteroid_collision(struct Asteroid *asteroid);
+// The asteroid is gone straight away; asteroid_tick adds its fragments once
+// the kills are flushed, so they can use its slot. Does nothing if the
+// asteroid is already gone.
+void asteroid_collision(entity_handle_t asteroid);
+
+// Flag the asteroid as hit. It is split or destroyed on the next
+// asteroid_tick. Does nothing if the asteroid is already gone.
+void asteroid_markCollision(entity_handle_t asteroid);
 
 // starts asteroid state machine, it doesn't really have that much to do
 void asteroid_init();
 
-// standard tick function, capable of adding, drawing, moving, and destroying asteroids
+// standard tick function, capable of adding, moving, and destroying asteroids
 // as dictated by control program
 void asteroid_tick();
 
-uint8_t asteroid_getCount();
+// Move every asteroid in play by one tick, wrapping at the screen edges.
+// asteroid_tick does this after splitting the asteroids that were hit.
+void asteroid_moveAll();
+
+// Submit every asteroid in play to the render stage, drawn alpha of the way
+// (see RENDER_ALPHA_ONE) from where it was before the last tick to where it
+// is now. Call once per frame.
+void asteroid_draw(uint16_t alpha);
+
+uint16_t asteroid_getCount();
+
+// Largest number of asteroids that have been in play at once since
+// asteroid_init.
+uint16_t asteroid_getHighWaterMark();
+
+// Number of asteroids that could not be added because storage was full.
+uint32_t asteroid_getFailedAcquireCount();
+
+// Handle of the asteroid at index of the view, for holding on to it or
+// handing it to another module; ENTITY_HANDLE_NONE past the end.
+entity_handle_t asteroid_getHandle(uint16_t index);
 
-struct Asteroid* asteroid_getHeadAsteroid();
+// Get read-only access to every asteroid in play (see entity.h). Indices are
+// only good until the next asteroid_tick.
+entity_view_t asteroid_getView();
 
-struct Asteroid* asteroid_getTailAsteroid();
+// Fold the asteroid state into hash (see stateHash.h) and return the result.
+uint32_t asteroid_hashState(uint32_t hash);
 
 void asteroid_eraseAll();
 
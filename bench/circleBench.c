@@ -0,0 +1,99 @@
+// Times framebuffer_drawCircle and framebuffer_fillCircle at the radii the
+// game draws, with centres spread over and just past the screen so some
+// circles are clipped. Built twice: with the span tables
+// (CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS) and with the midpoint routines
+// only. Prints a checksum of the framebuffer after each pass, which must be
+// the same in both builds.
+//
+// usage: circleBench [iterations]
+
+#define _POSIX_C_SOURCE 199309L
+#include "config.h"
+#include "framebuffer.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 200000
+#define NS_PER_SECOND 1000000000ULL
+#define POSITION_COUNT 1024
+
+// Large, medium and small asteroids, then lasers.
+static const int16_t radii[] = {24, 12, 6, 2};
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+} position_t;
+
+static position_t positions[POSITION_COUNT];
+
+static uint64_t bench_nowNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+// Centres up to r past each edge, from a fixed LCG so both builds draw the
+// same circles.
+static void bench_placeCircles(int16_t r) {
+  uint32_t seed = 12345;
+  for (uint16_t i = 0; i < POSITION_COUNT; i++) {
+    seed = seed * 1103515245u + 12345u;
+    positions[i].x = (int16_t)((seed >> 8) % (FRAMEBUFFER_WIDTH + 2 * r)) - r;
+    seed = seed * 1103515245u + 12345u;
+    positions[i].y = (int16_t)((seed >> 8) % (FRAMEBUFFER_HEIGHT + 2 * r)) - r;
+  }
+}
+
+// FNV-1a over every pixel of the frame being drawn.
+static uint32_t bench_checksum() {
+  uint32_t checksum = 2166136261u;
+  for (int16_t y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+    for (int16_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+      checksum = (checksum ^ framebuffer_getPixel(x, y)) * 16777619u;
+    }
+  }
+  return checksum;
+}
+
+// Draw iterations circles of radius r, each in a different colour so the
+// checksum also covers the order of overlapping writes. Returns ns/circle.
+static double bench_run(int16_t r, bool filled, uint32_t iterations) {
+  framebuffer_init();
+  bench_placeCircles(r);
+  uint64_t start = bench_nowNs();
+  for (uint32_t i = 0; i < iterations; i++) {
+    const position_t *p = &positions[i % POSITION_COUNT];
+    if (filled) {
+      framebuffer_fillCircle(p->x, p->y, r, (uint16_t)i);
+    } else {
+      framebuffer_drawCircle(p->x, p->y, r, (uint16_t)i);
+    }
+  }
+  uint64_t elapsed = bench_nowNs() - start;
+  return iterations ? (double)elapsed / iterations : 0;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t iterations =
+      argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+
+  printf("circles: %s\n", CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+                              ? "span tables"
+                              : "midpoint");
+  printf("iterations: %lu\n", (unsigned long)iterations);
+  for (uint8_t i = 0; i < sizeof radii / sizeof radii[0]; i++) {
+    double outlineNs = bench_run(radii[i], false, iterations);
+    uint32_t outlineChecksum = bench_checksum();
+    double fillNs = bench_run(radii[i], true, iterations);
+    uint32_t fillChecksum = bench_checksum();
+    printf("r=%2d  outline ns/circle: %7.2f (checksum %08lx)  "
+           "fill ns/circle: %7.2f (checksum %08lx)\n",
+           radii[i], outlineNs, (unsigned long)outlineChecksum, fillNs,
+           (unsigned long)fillChecksum);
+  }
+  return EXIT_SUCCESS;
+}
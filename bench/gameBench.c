@@ -0,0 +1,357 @@
+// Times the game's hot paths over parameterized scenarios:
+// - moving the asteroids
+// - building the collision grid
+// - the laser and ship collision tests
+// - moving (turning and thrusting) the ship
+// - one simulation tick
+// - one whole tick of frames, which is what the board's timer runs (tickAll)
+//
+// Every repetition starts from a fresh scenario, runs the warmup ops
+// untimed, then times the same number of ops. The game is deterministic, so
+// repetitions differ only by machine noise. Prints a table and, with -o,
+// writes the results as JSON.
+//
+// usage: gameBench [-a asteroids] [-l lasers] [-L level] [-n] [-w warmup]
+//                  [-r repetitions] [-i iterations] [-j threads]
+//                  [-b benchmark] [-o results.json]
+//   -a, -l, -L, -n  run one scenario: this many asteroids and lasers (at
+//       most MAX_LASER_COUNT), starting at this level, with rendering off for
+//       -n. Without any of them the built-in scenarios run.
+//   -w  untimed ops before each repetition (default DEFAULT_WARMUP)
+//   -r  timed repetitions of each benchmark (default DEFAULT_REPETITIONS)
+//   -i  ops per repetition. Tick benchmarks default to DEFAULT_TICKS, so
+//       they always cover the same stretch of the game. The rest default to
+//       enough ops for about TARGET_REPETITION_NS, going by a calibration
+//       run.
+//   -j  threads for the per-entity phases (see parallel.h), default 1
+//   -b  only run the benchmark with this name
+//   -o  write the results as JSON to this file
+
+#define _POSIX_C_SOURCE 200809L
+#include "asteroid.h"
+#include "collision.h"
+#include "config.h"
+#include "display.h"
+#include "game.h"
+#include "gameLoop.h"
+#include "laser.h"
+#include "parallel.h"
+#include "spaceship.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NS_PER_SECOND 1000000000ULL
+#define DEFAULT_WARMUP 10
+#define DEFAULT_REPETITIONS 5
+#define DEFAULT_TICKS 50
+#define TARGET_REPETITION_NS 50000000ULL
+#define MAX_ITERATIONS 1000000
+#define MAX_RESULTS 64
+#define SCENARIO_SEED 12345
+#define USAGE                                                                  \
+  "usage: %s [-a asteroids] [-l lasers] [-L level] [-n] [-w warmup] "          \
+  "[-r repetitions] [-i iterations] [-j threads] [-b benchmark] "              \
+  "[-o results.json]\n"
+
+typedef struct {
+  const char *name;
+  uint16_t asteroids; // Including the level's own.
+  uint16_t lasers;
+  uint8_t level;
+  bool rendering;
+} bench_scenario_t;
+
+typedef struct {
+  const char *name;
+  void (*op)();
+  bool isTick; // One op is one game tick, so ticks/s means something.
+} bench_benchmark_t;
+
+typedef struct {
+  const bench_scenario_t *scenario;
+  const bench_benchmark_t *benchmark;
+  uint32_t iterations;
+  double meanNs; // Per op, over the repetitions.
+  double varianceNs;
+  double minNs;
+  double maxNs;
+} bench_result_t;
+
+static const bench_scenario_t builtInScenarios[] = {
+    {.name = "board", .asteroids = 4, .lasers = 5, .level = 4,
+     .rendering = true},
+    {.name = "crowded", .asteroids = 1000, .lasers = 100, .level = 1,
+     .rendering = true},
+    {.name = "stress", .asteroids = 20000, .lasers = 255, .level = 1,
+     .rendering = false},
+};
+
+static void bench_moveAsteroids() { asteroid_moveAll(); }
+
+static void bench_buildGrid() { collision_buildGrid(asteroid_getView()); }
+
+static void bench_laserCollision() { game_checkLaserCollision(); }
+
+static void bench_shipCollision() { game_checkShipCollision(); }
+
+static void bench_moveShip() { spaceship_moveShip(true, false, true, false); }
+
+static void bench_tick() { gameLoop_tick(); }
+
+// What the board runs for one tick: CONFIG_FRAMES_PER_TICK timer periods.
+static void bench_tickAll() {
+  for (uint8_t frame = 0; frame < CONFIG_FRAMES_PER_TICK; frame++) {
+    gameLoop_frame();
+  }
+}
+
+static const bench_benchmark_t benchmarks[] = {
+    {.name = "moveAsteroids", .op = bench_moveAsteroids},
+    {.name = "buildGrid", .op = bench_buildGrid},
+    {.name = "laserCollision", .op = bench_laserCollision},
+    {.name = "shipCollision", .op = bench_shipCollision},
+    {.name = "moveShip", .op = bench_moveShip},
+    {.name = "tick", .op = bench_tick, .isTick = true},
+    {.name = "tickAll", .op = bench_tickAll, .isTick = true},
+};
+
+static bench_result_t results[MAX_RESULTS];
+static uint8_t resultCount;
+
+static uint64_t bench_nowNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+// Next value of a fixed LCG, so every run builds the same scenario.
+static uint32_t bench_random(uint32_t *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 8;
+}
+
+// Start the game at the scenario's level and top it up to the scenario's
+// asteroid and laser counts. One tick then brings every subsystem into play,
+// and the grid is built for the collision benchmarks.
+static void bench_setUp(const bench_scenario_t *scenario) {
+  static const uint8_t radii[] = {24, 12, 6};
+  uint32_t seed = SCENARIO_SEED;
+  gameLoop_init();
+  gameLoop_setRendering(scenario->rendering);
+  game_startLevel(scenario->level);
+  while (asteroid_getCount() < scenario->asteroids) {
+    int16_t x = bench_random(&seed) % DISPLAY_WIDTH;
+    int16_t y = bench_random(&seed) % DISPLAY_HEIGHT;
+    int8_t xVelocity = (int8_t)(bench_random(&seed) % 7) - 3;
+    int8_t yVelocity = (int8_t)(bench_random(&seed) % 7) - 3;
+    if (!asteroid_addAsteroid(x, y, xVelocity, yVelocity,
+                              radii[bench_random(&seed) % 3])) {
+      break;
+    }
+  }
+  while (laser_getCount() < scenario->lasers) {
+    int16_t x = bench_random(&seed) % DISPLAY_WIDTH;
+    int16_t y = bench_random(&seed) % DISPLAY_HEIGHT;
+    int8_t xVelocity = (int8_t)(bench_random(&seed) % 21) - 10;
+    int8_t yVelocity = (int8_t)(bench_random(&seed) % 21) - 10;
+    if (!laser_addLaser(x, y, xVelocity, yVelocity)) {
+      break;
+    }
+  }
+  gameLoop_tick();
+  collision_buildGrid(asteroid_getView());
+}
+
+// Run op count times on the scenario as it stands. Returns the time taken.
+static uint64_t bench_time(const bench_benchmark_t *benchmark,
+                           uint32_t count) {
+  uint64_t start = bench_nowNs();
+  for (uint32_t i = 0; i < count; i++) {
+    benchmark->op();
+  }
+  return bench_nowNs() - start;
+}
+
+// Enough ops for about TARGET_REPETITION_NS, judged from the warmup.
+static uint32_t bench_calibrate(const bench_scenario_t *scenario,
+                                const bench_benchmark_t *benchmark,
+                                uint32_t warmup) {
+  uint32_t probe = warmup > 0 ? warmup : 1;
+  bench_setUp(scenario);
+  uint64_t perOp = bench_time(benchmark, probe) / probe;
+  uint64_t iterations = TARGET_REPETITION_NS / (perOp > 0 ? perOp : 1);
+  if (iterations < 1) {
+    iterations = 1;
+  }
+  return iterations > MAX_ITERATIONS ? MAX_ITERATIONS : iterations;
+}
+
+static void bench_run(const bench_scenario_t *scenario,
+                      const bench_benchmark_t *benchmark, uint32_t warmup,
+                      uint32_t repetitions, uint32_t iterations) {
+  if (iterations == 0) {
+    iterations = benchmark->isTick
+                     ? DEFAULT_TICKS
+                     : bench_calibrate(scenario, benchmark, warmup);
+  }
+  double sum = 0;
+  double sumSquares = 0;
+  double minNs = INFINITY;
+  double maxNs = 0;
+  for (uint32_t r = 0; r < repetitions; r++) {
+    bench_setUp(scenario);
+    bench_time(benchmark, warmup);
+    double ns = (double)bench_time(benchmark, iterations) / iterations;
+    sum += ns;
+    sumSquares += ns * ns;
+    minNs = ns < minNs ? ns : minNs;
+    maxNs = ns > maxNs ? ns : maxNs;
+  }
+  double mean = sum / repetitions;
+  // Sample variance of the per-repetition means.
+  double variance = repetitions > 1 ? (sumSquares - sum * mean) /
+                                          (repetitions - 1)
+                                    : 0;
+  bench_result_t *result = &results[resultCount++];
+  *result = (bench_result_t){.scenario = scenario,
+                             .benchmark = benchmark,
+                             .iterations = iterations,
+                             .meanNs = mean,
+                             .varianceNs = variance > 0 ? variance : 0,
+                             .minNs = minNs,
+                             .maxNs = maxNs};
+  printf("%-8s %-15s %8lu ops %13.1f ns/op +-%5.1f%%", scenario->name,
+         benchmark->name, (unsigned long)iterations, mean,
+         mean > 0 ? 100.0 * sqrt(result->varianceNs) / mean : 0);
+  if (benchmark->isTick) {
+    printf(" %10.0f ticks/s", NS_PER_SECOND / mean);
+  }
+  printf("\n");
+}
+
+static bool bench_writeJson(const char *path, uint32_t warmup,
+                            uint32_t repetitions) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return false;
+  }
+  fprintf(file,
+          "{\n  \"tickPeriodSeconds\": %g,\n  \"framesPerTick\": %d,\n"
+          "  \"threads\": %u,\n  \"warmup\": %lu,\n  \"repetitions\": %lu,\n"
+          "  \"results\": [",
+          CONFIG_TICK_PERIOD, CONFIG_FRAMES_PER_TICK,
+          parallel_getThreadCount(), (unsigned long)warmup,
+          (unsigned long)repetitions);
+  for (uint8_t i = 0; i < resultCount; i++) {
+    const bench_result_t *result = &results[i];
+    const bench_scenario_t *scenario = result->scenario;
+    fprintf(file,
+            "%s\n    {\"scenario\": \"%s\", \"asteroids\": %u, "
+            "\"lasers\": %u, \"level\": %u, \"rendering\": %s,\n"
+            "     \"benchmark\": \"%s\", \"iterations\": %lu,\n"
+            "     \"nsPerOp\": {\"mean\": %.3f, \"stddev\": %.3f, "
+            "\"variance\": %.3f, \"min\": %.3f, \"max\": %.3f},\n"
+            "     \"opsPerSecond\": %.1f",
+            i > 0 ? "," : "", scenario->name, scenario->asteroids,
+            scenario->lasers, scenario->level,
+            scenario->rendering ? "true" : "false", result->benchmark->name,
+            (unsigned long)result->iterations, result->meanNs,
+            sqrt(result->varianceNs), result->varianceNs, result->minNs,
+            result->maxNs, NS_PER_SECOND / result->meanNs);
+    if (result->benchmark->isTick) {
+      fprintf(file, ", \"ticksPerSecond\": %.1f",
+              NS_PER_SECOND / result->meanNs);
+    }
+    fprintf(file, "}");
+  }
+  fprintf(file, "\n  ]\n}\n");
+  return fclose(file) == 0;
+}
+
+int main(int argc, char *argv[]) {
+  bench_scenario_t custom = {.name = "custom",
+                             .asteroids = 0,
+                             .lasers = 0,
+                             .level = 1,
+                             .rendering = true};
+  bool useCustom = false;
+  uint32_t warmup = DEFAULT_WARMUP;
+  uint32_t repetitions = DEFAULT_REPETITIONS;
+  uint32_t iterations = 0;
+  long threads = 1;
+  const char *only = NULL;
+  const char *jsonPath = NULL;
+  int option;
+  while ((option = getopt(argc, argv, "a:l:L:nw:r:i:j:b:o:")) != -1) {
+    switch (option) {
+    case 'a':
+      custom.asteroids = strtoul(optarg, NULL, 0);
+      useCustom = true;
+      break;
+    case 'l':
+      custom.lasers = strtoul(optarg, NULL, 0);
+      custom.lasers = custom.lasers > MAX_LASER_COUNT ? MAX_LASER_COUNT
+                                                      : custom.lasers;
+      useCustom = true;
+      break;
+    case 'L':
+      custom.level = strtoul(optarg, NULL, 0);
+      useCustom = true;
+      break;
+    case 'n':
+      custom.rendering = false;
+      useCustom = true;
+      break;
+    case 'w':
+      warmup = strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      repetitions = strtoul(optarg, NULL, 0);
+      break;
+    case 'i':
+      iterations = strtoul(optarg, NULL, 0);
+      break;
+    case 'j':
+      threads = strtol(optarg, NULL, 0);
+      break;
+    case 'b':
+      only = optarg;
+      break;
+    case 'o':
+      jsonPath = optarg;
+      break;
+    default:
+      fprintf(stderr, USAGE, argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (repetitions < 1) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  parallel_init(threads < 1 ? 1 : threads > UINT8_MAX ? UINT8_MAX : threads);
+  display_init();
+  const bench_scenario_t *scenarios = useCustom ? &custom : builtInScenarios;
+  uint8_t scenarioCount =
+      useCustom ? 1 : sizeof builtInScenarios / sizeof builtInScenarios[0];
+  for (uint8_t s = 0; s < scenarioCount; s++) {
+    for (uint8_t b = 0; b < sizeof benchmarks / sizeof benchmarks[0]; b++) {
+      if (only == NULL || strcmp(only, benchmarks[b].name) == 0) {
+        bench_run(&scenarios[s], &benchmarks[b], warmup, repetitions,
+                  iterations);
+      }
+    }
+  }
+  if (jsonPath != NULL && !bench_writeJson(jsonPath, warmup, repetitions)) {
+    fprintf(stderr, "could not write %s\n", jsonPath);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+// Times the spaceship's vector math in whichever number format linearAlg was
+// built with (CONFIG_LINEARALG_FIXED_POINT), and the batched transform against
+// one vector at a time. Prints a checksum of the results. The fixed-point
+// checksum should match on every platform.
+//
+// usage: linearAlgBench [iterations]
+
+#define _POSIX_C_SOURCE 199309L
+#include "linearAlg.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 1000000
+#define NS_PER_SECOND 1000000000ULL
+#define ROTATION_ANGLE_RAD (15.0 * 3.14159265358979323846 / 180.0)
+#define DRAG_VELOCITY 30.0
+#define BATCH_SIZE 256
+
+static uint64_t bench_nowNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+// Fold a result into the checksum. Doubles are rounded to 1/65536 first so the
+// two builds produce comparable numbers.
+static uint32_t bench_mix(uint32_t checksum, elementSize_t value) {
+#if CONFIG_LINEARALG_FIXED_POINT
+  uint32_t bits = (uint32_t)value;
+#else
+  uint32_t bits = (uint32_t)(int32_t)lround(value * 65536.0);
+#endif
+  return (checksum ^ bits) * 16777619u;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t iterations =
+      argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+
+  matrix2x2_t rotation = {
+      .vect1 = {.x = LINEARALG_FROM_DOUBLE(cos(ROTATION_ANGLE_RAD)),
+                .y = LINEARALG_FROM_DOUBLE(sin(ROTATION_ANGLE_RAD))},
+      .vect2 = {.x = LINEARALG_FROM_DOUBLE(-sin(ROTATION_ANGLE_RAD)),
+                .y = LINEARALG_FROM_DOUBLE(cos(ROTATION_ANGLE_RAD))}};
+  vector2D_t vertex = {.x = LINEARALG_FROM_DOUBLE(7.0),
+                       .y = LINEARALG_FROM_DOUBLE(10.0)};
+  vector2D_t velocity = {.x = LINEARALG_FROM_DOUBLE(3.5),
+                         .y = LINEARALG_FROM_DOUBLE(-2.25)};
+  uint32_t checksum = 2166136261u;
+
+  // One iteration is what the ship does each tick: rotate a vertex, then
+  // normalize the velocity to apply drag.
+  uint64_t start = bench_nowNs();
+  for (uint32_t i = 0; i < iterations; i++) {
+    linearAlg_matVectMultAx2D(rotation, &vertex);
+    elementSize_t magnitude = linearAlg_calcMag(velocity);
+    vector2D_t direction = linearAlg_normVect(velocity, magnitude);
+    elementSize_t drag =
+        LINEARALG_DIV(LINEARALG_MUL(magnitude, magnitude),
+                      LINEARALG_FROM_DOUBLE(DRAG_VELOCITY));
+    velocity.x -= LINEARALG_MUL(direction.x, drag);
+    velocity.y -= LINEARALG_MUL(direction.y, drag);
+    // Keep the velocity from decaying to zero so every iteration does work.
+    velocity.x += LINEARALG_MUL(direction.y, LINEARALG_FROM_DOUBLE(0.5));
+    velocity.y += LINEARALG_FROM_DOUBLE(0.25);
+    checksum = bench_mix(checksum, vertex.x);
+    checksum = bench_mix(checksum, velocity.y);
+  }
+  uint64_t elapsed = bench_nowNs() - start;
+
+  // Rotate a batch of points one at a time and then with the batched call.
+  static vector2D_t points[BATCH_SIZE];
+  for (uint16_t i = 0; i < BATCH_SIZE; i++) {
+    points[i] = (vector2D_t){.x = LINEARALG_FROM_INT(i % 17 - 8),
+                             .y = LINEARALG_FROM_INT(i % 13 - 6)};
+  }
+  uint32_t batches = iterations / BATCH_SIZE + 1;
+  start = bench_nowNs();
+  for (uint32_t b = 0; b < batches; b++) {
+    for (uint16_t i = 0; i < BATCH_SIZE; i++) {
+      linearAlg_matVectMultAx2D(rotation, &points[i]);
+    }
+  }
+  uint64_t singleElapsed = bench_nowNs() - start;
+  start = bench_nowNs();
+  for (uint32_t b = 0; b < batches; b++) {
+    linearAlg_transformArray(rotation, points, points, BATCH_SIZE);
+  }
+  uint64_t batchElapsed = bench_nowNs() - start;
+  for (uint16_t i = 0; i < BATCH_SIZE; i++) {
+    checksum = bench_mix(checksum, points[i].x);
+  }
+
+  double pointCount = (double)batches * BATCH_SIZE;
+  printf("format: %s\n",
+         CONFIG_LINEARALG_FIXED_POINT ? "Q16.16 fixed point" : "double");
+  printf("iterations: %lu\n", (unsigned long)iterations);
+  printf("ns/iteration: %.2f\n", iterations ? (double)elapsed / iterations : 0);
+  printf("ns/point, one at a time: %.2f\n", singleElapsed / pointCount);
+  printf("ns/point, batched: %.2f\n", batchElapsed / pointCount);
+  printf("checksum: %08lx\n", (unsigned long)checksum);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+#include "collision.h"
+#include "asteroid.h"
+#include "config.h"
+#include "display.h"
+#include "parallel.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GRID_CELL_COUNT (COLLISION_GRID_COLS * COLLISION_GRID_ROWS)
+
+#define SQUARE_TERMS(A) ((A) * (A))
+// Fewest asteroids one thread bins at a time (see parallel.h).
+#define BIN_GRAIN 4096
+// Per-worker counters are kept this many bytes apart so threads counting at
+// the same time do not fight over a cache line.
+#define CACHE_LINE_SIZE 64
+
+// The grid is rebuilt from scratch every tick with a counting sort: the
+// asteroids in cell c are cellEntries[cellStart[c]] up to (but not including)
+// cellEntries[cellStart[c + 1]]. All storage is static. Queries and
+// narrow-phase tests can run on several threads at once, so each worker
+// thread has its own query result and stats.
+static uint16_t cellStart[GRID_CELL_COUNT + 1];
+static uint16_t cellFill[GRID_CELL_COUNT];
+static uint16_t cellEntries[MAX_ASTEROID_COUNT];
+static uint16_t asteroidCell[MAX_ASTEROID_COUNT];
+static uint16_t queryResult[CONFIG_PARALLEL_MAX_WORKERS][MAX_ASTEROID_COUNT];
+
+static entity_view_t gridAsteroids;
+static uint8_t gridMaxRadius;
+static struct {
+  _Alignas(CACHE_LINE_SIZE) collision_stats_t counts;
+} stats[CONFIG_PARALLEL_MAX_WORKERS];
+
+// Floor division that also rounds negative numerators down.
+static int16_t collision_floorDiv(int16_t value, int16_t divisor) {
+  return (value >= 0) ? (value / divisor) : -((divisor - 1 - value) / divisor);
+}
+
+// Map any column or row number onto the grid, wrapping like the screen does.
+static int16_t collision_wrapIndex(int16_t index, int16_t size) {
+  index %= size;
+  return (index < 0) ? index + size : index;
+}
+
+static uint16_t collision_cellOf(int16_t x, int16_t y) {
+  int16_t col = collision_wrapIndex(collision_floorDiv(x, COLLISION_CELL_SIZE),
+                                    COLLISION_GRID_COLS);
+  int16_t row = collision_wrapIndex(collision_floorDiv(y, COLLISION_CELL_SIZE),
+                                    COLLISION_GRID_ROWS);
+  return row * COLLISION_GRID_COLS + col;
+}
+
+// Find the cell of asteroids [begin, end) of the view being binned.
+static void collision_binRange(uint16_t begin, uint16_t end, void *context) {
+  (void)context;
+  for (uint16_t i = begin; i < end; i++) {
+    asteroidCell[i] = collision_cellOf(gridAsteroids.x[i], gridAsteroids.y[i]);
+  }
+}
+
+// Bin every asteroid in the view into the grid.
+void collision_buildGrid(entity_view_t asteroids) {
+  gridAsteroids = asteroids;
+  gridMaxRadius = 0;
+  for (uint16_t c = 0; c <= GRID_CELL_COUNT; c++) {
+    cellStart[c] = 0;
+  }
+
+  // Count the asteroids in each cell, then turn the counts into offsets.
+  // Only finding the cells is split across threads; the counting sort keeps
+  // each cell's entries in index order.
+  parallel_for(asteroids.count, BIN_GRAIN, collision_binRange, NULL);
+  for (uint16_t i = 0; i < asteroids.count; i++) {
+    cellStart[asteroidCell[i] + 1]++;
+    if (asteroids.radius[i] > gridMaxRadius) {
+      gridMaxRadius = asteroids.radius[i];
+    }
+  }
+  for (uint16_t c = 0; c < GRID_CELL_COUNT; c++) {
+    cellStart[c + 1] += cellStart[c];
+    cellFill[c] = cellStart[c];
+  }
+  for (uint16_t i = 0; i < asteroids.count; i++) {
+    cellEntries[cellFill[asteroidCell[i]]++] = i;
+  }
+}
+
+// Find the asteroids whose circles could come within reach pixels of (x, y).
+const uint16_t *collision_queryGrid(int16_t x, int16_t y, int16_t reach,
+                                    uint16_t *count) {
+  uint16_t *result = queryResult[parallel_getWorker()];
+  *count = 0;
+  if (gridAsteroids.count == 0) {
+    return result;
+  }
+
+  // Every asteroid center that can matter is inside this box. When the box is
+  // at least as wide as the grid, visit each column (or row) exactly once so
+  // nothing is reported twice.
+  int16_t span = reach + gridMaxRadius;
+  int16_t firstCol = collision_floorDiv(x - span, COLLISION_CELL_SIZE);
+  int16_t lastCol = collision_floorDiv(x + span, COLLISION_CELL_SIZE);
+  int16_t firstRow = collision_floorDiv(y - span, COLLISION_CELL_SIZE);
+  int16_t lastRow = collision_floorDiv(y + span, COLLISION_CELL_SIZE);
+  if (lastCol - firstCol + 1 > COLLISION_GRID_COLS) {
+    lastCol = firstCol + COLLISION_GRID_COLS - 1;
+  }
+  if (lastRow - firstRow + 1 > COLLISION_GRID_ROWS) {
+    lastRow = firstRow + COLLISION_GRID_ROWS - 1;
+  }
+
+  for (int16_t row = firstRow; row <= lastRow; row++) {
+    uint16_t rowOffset =
+        collision_wrapIndex(row, COLLISION_GRID_ROWS) * COLLISION_GRID_COLS;
+    for (int16_t col = firstCol; col <= lastCol; col++) {
+      uint16_t cell = rowOffset + collision_wrapIndex(col, COLLISION_GRID_COLS);
+      for (uint16_t e = cellStart[cell]; e < cellStart[cell + 1]; e++) {
+        result[(*count)++] = cellEntries[e];
+      }
+    }
+  }
+  return result;
+}
+
+// Shortest signed distance from 0 to delta on a screen that wraps every
+// extent pixels.
+int16_t collision_wrapDelta(int16_t delta, int16_t extent) {
+  if (delta > extent / 2) {
+    delta -= extent;
+  } else if (delta < -extent / 2) {
+    delta += extent;
+  }
+  return delta;
+}
+
+// Does the segment from f to f + d come closer than reach to the origin at
+// any point? Everything is relative to a circle's center, in whole pixels.
+static bool collision_segmentWithin(int32_t fx, int32_t fy, int32_t dx,
+                                    int32_t dy, int32_t reach) {
+  int32_t dd = SQUARE_TERMS(dx) + SQUARE_TERMS(dy);
+  int32_t fd = fx * dx + fy * dy;
+  if (dd == 0 || fd >= 0) {
+    // A point, or heading away: the start is the closest.
+    return SQUARE_TERMS(fx) + SQUARE_TERMS(fy) < SQUARE_TERMS(reach);
+  }
+  if (-fd >= dd) {
+    // The closest approach is past the end.
+    return SQUARE_TERMS(fx + dx) + SQUARE_TERMS(fy + dy) < SQUARE_TERMS(reach);
+  }
+  // The closest approach is part way along. Its squared distance is
+  // |f|^2 - (f.d)^2 / |d|^2; multiply through by |d|^2 to stay in integers.
+  int64_t distSq =
+      (int64_t)(SQUARE_TERMS(fx) + SQUARE_TERMS(fy)) * dd - (int64_t)fd * fd;
+  return distSq < (int64_t)SQUARE_TERMS(reach) * dd;
+}
+
+// Swept narrow-phase test of a moving circle against one asteroid. The start
+// point is measured across the screen wrap; the motion itself is not wrapped.
+bool collision_segmentHitsAsteroid(uint16_t index, int16_t x0, int16_t y0,
+                                   int16_t x1, int16_t y1, uint8_t radius) {
+  // Work relative to the asteroid center: f is the start point and d the
+  // motion, so the path is f + t * d for t in [0, 1].
+  int32_t fx = collision_wrapDelta(x0 - gridAsteroids.x[index], DISPLAY_WIDTH);
+  int32_t fy = collision_wrapDelta(y0 - gridAsteroids.y[index], DISPLAY_HEIGHT);
+  collision_stats_t *workerStats = &stats[parallel_getWorker()].counts;
+  workerStats->candidatePairs++;
+  bool hit = collision_segmentWithin(fx, fy, x1 - x0, y1 - y0,
+                                     gridAsteroids.radius[index] + radius);
+  if (hit) {
+    workerStats->confirmedHits++;
+  }
+  return hit;
+}
+
+// Exact test of the hull against one asteroid, relative to the asteroid's
+// center. The swept bounding circle rules out almost every candidate. After
+// that the asteroid is hit if any edge where the hull is now, or the path any
+// vertex took to get there, comes within its radius, or if its center is
+// inside the hull (an even number of edge crossings to its right means
+// outside).
+static bool collision_hullHitsAsteroid(const collision_hull_t *hull,
+                                       uint16_t index) {
+  int32_t cx = collision_wrapDelta(hull->centerX - gridAsteroids.x[index],
+                                   DISPLAY_WIDTH);
+  int32_t cy = collision_wrapDelta(hull->centerY - gridAsteroids.y[index],
+                                   DISPLAY_HEIGHT);
+  int32_t radius = gridAsteroids.radius[index];
+  if (!collision_segmentWithin(cx - hull->dx, cy - hull->dy, hull->dx,
+                               hull->dy, hull->boundingRadius + radius)) {
+    return false;
+  }
+  bool inside = false;
+  for (uint8_t i = 0; i < hull->vertexCount; i++) {
+    uint8_t next = i + 1 < hull->vertexCount ? i + 1 : 0;
+    int32_t ax = cx + hull->vertexX[i];
+    int32_t ay = cy + hull->vertexY[i];
+    int32_t bx = cx + hull->vertexX[next];
+    int32_t by = cy + hull->vertexY[next];
+    if (collision_segmentWithin(ax, ay, bx - ax, by - ay, radius) ||
+        collision_segmentWithin(ax - hull->dx, ay - hull->dy, hull->dx,
+                                hull->dy, radius)) {
+      return true;
+    }
+    // The edge crosses the positive x axis when its ends are on opposite
+    // sides of it and a x b has the sign of by - ay.
+    if ((ay > 0) != (by > 0) &&
+        ((int64_t)ax * by - (int64_t)bx * ay > 0) == (by > ay)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+uint16_t collision_hullHitsAsteroids(const collision_hull_t *hull,
+                                     const uint16_t *candidates,
+                                     uint16_t candidateCount, uint16_t *hits,
+                                     uint16_t maxHits) {
+  collision_stats_t *workerStats = &stats[parallel_getWorker()].counts;
+  uint16_t hitCount = 0;
+  for (uint16_t c = 0; c < candidateCount && hitCount < maxHits; c++) {
+    workerStats->candidatePairs++;
+    if (collision_hullHitsAsteroid(hull, candidates[c])) {
+      workerStats->confirmedHits++;
+      hits[hitCount++] = candidates[c];
+    }
+  }
+  return hitCount;
+}
+
+// Sum of every worker's stats.
+collision_stats_t collision_getStats() {
+  collision_stats_t total = {.candidatePairs = 0, .confirmedHits = 0};
+  for (uint8_t w = 0; w < CONFIG_PARALLEL_MAX_WORKERS; w++) {
+    total.candidatePairs += stats[w].counts.candidatePairs;
+    total.confirmedHits += stats[w].counts.confirmedHits;
+  }
+  return total;
+}
+
+void collision_resetStats() {
+  for (uint8_t w = 0; w < CONFIG_PARALLEL_MAX_WORKERS; w++) {
+    stats[w].counts =
+        (collision_stats_t){.candidatePairs = 0, .confirmedHits = 0};
+  }
+}
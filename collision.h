@@ -0,0 +1,86 @@
+#ifndef COLLISION_H_
+#define COLLISION_H_
+
+#include "entity.h"
+#include <display.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Side length in pixels of one broadphase grid cell. Asteroids are binned by
+// their center, and queries widen their search by the largest asteroid radius,
+// so any size works; 40 divides the 320x240 display evenly.
+#define COLLISION_CELL_SIZE 40
+#define COLLISION_GRID_COLS                                                    \
+  ((DISPLAY_WIDTH + COLLISION_CELL_SIZE - 1) / COLLISION_CELL_SIZE)
+#define COLLISION_GRID_ROWS                                                    \
+  ((DISPLAY_HEIGHT + COLLISION_CELL_SIZE - 1) / COLLISION_CELL_SIZE)
+
+// Counters for judging how well the broadphase prunes. A candidate pair is
+// one object the grid handed to a narrow-phase test; a confirmed hit is a
+// test that came back true.
+typedef struct {
+  uint32_t candidatePairs;
+  uint32_t confirmedHits;
+} collision_stats_t;
+
+// Most vertices a collision_hull_t can have.
+#define COLLISION_MAX_HULL_VERTICES 8
+
+// A closed polygon for the exact narrow phase, where it is at the end of the
+// tick. Vertices are whole-pixel offsets from the center in drawing order;
+// the edges join each vertex to the next and the last back to the first, and
+// the polygon need not be convex. The hull is swept back along (dx, dy), how
+// far its center moved this tick: an asteroid counts as touched if it
+// overlaps an edge, the path of a vertex, or the inside of the hull.
+typedef struct {
+  int16_t centerX;
+  int16_t centerY;
+  int16_t dx;
+  int16_t dy;
+  uint8_t boundingRadius; // Every vertex is within this of the center.
+  uint8_t vertexCount;
+  int16_t vertexX[COLLISION_MAX_HULL_VERTICES];
+  int16_t vertexY[COLLISION_MAX_HULL_VERTICES];
+} collision_hull_t;
+
+// Bin every asteroid in the view into the grid. Call once per tick after the
+// asteroids have moved and before any queries; the view must stay unchanged
+// until the queries are done.
+void collision_buildGrid(entity_view_t asteroids);
+
+// Find the asteroids whose circles could come within reach pixels of (x, y),
+// looking across the screen wrap. Returns a list of asteroid indices that is
+// only valid until the next query on the same thread or build; its length
+// goes in *count. Queries and the narrow-phase tests below may run from
+// parallel_for jobs (see parallel.h).
+const uint16_t *collision_queryGrid(int16_t x, int16_t y, int16_t reach,
+                                    uint16_t *count);
+
+// Shortest signed distance from 0 to delta on a screen that wraps every
+// extent pixels.
+int16_t collision_wrapDelta(int16_t delta, int16_t extent);
+
+// Swept narrow-phase test: does a circle of the given radius, moving in a
+// straight line from (x0, y0) to (x1, y1) during the tick, touch the asteroid
+// at index of the view the grid was built from at any point along the way?
+// Uses exact integer segment-vs-circle math, so fast movers cannot step over
+// small asteroids. Updates the stats.
+bool collision_segmentHitsAsteroid(uint16_t index, int16_t x0, int16_t y0,
+                                   int16_t x1, int16_t y1, uint8_t radius);
+
+// Exact narrow phase of a polygon, such as the ship, against candidates of
+// the view the grid was built from, usually the result of one
+// collision_queryGrid. Writes up to maxHits of the asteroids the hull touches
+// to hits, in candidate order, and returns how many there are. Integer math
+// throughout; see collision_hull_t for what counts as touching. Updates the
+// stats.
+uint16_t collision_hullHitsAsteroids(const collision_hull_t *hull,
+                                     const uint16_t *candidates,
+                                     uint16_t candidateCount, uint16_t *hits,
+                                     uint16_t maxHits);
+
+collision_stats_t collision_getStats();
+
+void collision_resetStats();
+
+#endif /* COLLISION_H_ */
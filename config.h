@@ -1,6 +1,72 @@
 #ifndef CONFIG_LAB6
 #define CONFIG_LAB6
 
-#define CONFIG_TIMER_PERIOD 100.0E-3
+// Length of one simulation tick in seconds. Every tick advances the game by
+// exactly this much whatever the frame rate, so speeds are written per second
+// and turned into per-tick steps with CONFIG_PER_TICK.
+#define CONFIG_TICK_PERIOD 100.0E-3
+#define CONFIG_PER_TICK(perSecond) ((perSecond) * CONFIG_TICK_PERIOD)
+
+// Frames drawn per tick. Frames between ticks interpolate entity positions
+// between the last two ticks, so motion is smoother without simulating more
+// often. Set to 1 to draw once per tick with no interpolation.
+#ifndef CONFIG_FRAMES_PER_TICK
+#define CONFIG_FRAMES_PER_TICK 4
+#endif
+
+// The timer fires once per frame.
+#define CONFIG_TIMER_PERIOD (CONFIG_TICK_PERIOD / CONFIG_FRAMES_PER_TICK)
+
+// Keep a second framebuffer that mirrors what is on the panel, and only send
+// the pixels that differ from it when presenting. Set to 0 to save the memory
+// and send every pixel of each flushed region.
+#ifndef CONFIG_FRAMEBUFFER_DOUBLE_BUFFER
+#define CONFIG_FRAMEBUFFER_DOUBLE_BUFFER 1
+#endif
+
+// Only flush the regions marked dirty since the last present. Set to 0 to
+// flush the whole screen every tick.
+#ifndef CONFIG_FRAMEBUFFER_PARTIAL_FLUSH
+#define CONFIG_FRAMEBUFFER_PARTIAL_FLUSH 1
+#endif
+
+// Draw circles up to this radius from span tables built once at startup
+// instead of stepping the midpoint algorithm on every call. The largest
+// asteroid is 24. Set to 0 to always use the midpoint routines.
+#ifndef CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS
+#define CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS 24
+#endif
+
+// Use Q16.16 fixed point instead of double for the spaceship's vector math
+// (see linearAlg.h). Fixed point avoids the FPU and gives the same results on
+// every platform.
+#ifndef CONFIG_LINEARALG_FIXED_POINT
+#define CONFIG_LINEARALG_FIXED_POINT 0
+#endif
+
+// Time each subsystem's tick with the profiler (see profiler.h). Set to 0 to
+// leave the clock reads out of the game loop.
+#ifndef CONFIG_PROFILER
+#define CONFIG_PROFILER 1
+#endif
+
+// Most threads the per-entity phases of a tick can be spread over (see
+// parallel.h), which sizes the per-thread scratch. The board has one core;
+// the host build raises this.
+#ifndef CONFIG_PARALLEL_MAX_WORKERS
+#define CONFIG_PARALLEL_MAX_WORKERS 1
+#endif
+
+// Most detailed log level compiled in (see logger.h): 0 none, 1 error,
+// 2 warn, 3 info, 4 debug. Calls above it are removed by the preprocessor.
+#ifndef CONFIG_LOG_LEVEL
+#define CONFIG_LOG_LEVEL 3
+#endif
+
+// Seed every game's random numbers are derived from (see random.h). The same
+// seed and input always play out the same way.
+#ifndef CONFIG_RANDOM_SEED
+#define CONFIG_RANDOM_SEED 0x5eed
+#endif
 
 #endif /* CONFIG_LAB6 */
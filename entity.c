@@ -0,0 +1,218 @@
+#include "entity.h"
+#include "display.h"
+#include "motion.h"
+#include "parallel.h"
+#include "stateHash.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fewest entities one thread moves at a time (see parallel.h). Below twice
+// this the move runs on the calling thread.
+#define MOVE_GRAIN 4096
+
+#define HANDLE_ID_BITS 16
+#define HANDLE_ID_MASK 0xFFFF
+
+void entity_init(entity_store_t *store) {
+  entity_clear(store);
+  store->highWaterMark = 0;
+  store->failedCreateCount = 0;
+}
+
+entity_handle_t entity_create(entity_store_t *store, int16_t x, int16_t y,
+                              int8_t xVelocity, int8_t yVelocity,
+                              uint8_t radius) {
+  if (store->count >= store->capacity) {
+    store->failedCreateCount++;
+    return ENTITY_HANDLE_NONE;
+  }
+
+  // Every id in use has a slot, so there is a free id whenever there is a
+  // free slot.
+  uint16_t id = store->freeIdCount > 0 ? store->freeIds[--store->freeIdCount]
+                                       : store->idCount++;
+  uint16_t i = store->count;
+  store->x[i] = x;
+  store->y[i] = y;
+  store->previousX[i] = x;
+  store->previousY[i] = y;
+  store->xVelocity[i] = xVelocity;
+  store->yVelocity[i] = yVelocity;
+  store->radius[i] = radius;
+  store->age[i] = 0;
+  store->flags[i] = 0;
+  store->id[i] = id;
+  store->slot[id] = i;
+  ++store->count;
+  if (store->count > store->highWaterMark) {
+    store->highWaterMark = store->count;
+  }
+  return entity_getHandle(store, i);
+}
+
+entity_handle_t entity_getHandle(const entity_store_t *store, uint16_t index) {
+  if (index >= store->count) {
+    return ENTITY_HANDLE_NONE;
+  }
+  uint16_t id = store->id[index];
+  return (entity_handle_t)store->generation[id] << HANDLE_ID_BITS | id;
+}
+
+uint16_t entity_getIndex(const entity_store_t *store, entity_handle_t handle) {
+  uint16_t id = handle & HANDLE_ID_MASK;
+  if (id >= store->idCount ||
+      store->generation[id] != handle >> HANDLE_ID_BITS) {
+    return ENTITY_NONE;
+  }
+  uint16_t index = store->slot[id];
+  return store->flags[index] & ENTITY_FLAG_DEAD ? ENTITY_NONE : index;
+}
+
+// Queue the live entity at index for the next flush.
+static void entity_killIndex(entity_store_t *store, uint16_t index) {
+  store->flags[index] |= ENTITY_FLAG_DEAD;
+  store->kills[store->killCount++] = index;
+}
+
+bool entity_kill(entity_store_t *store, entity_handle_t handle) {
+  uint16_t index = entity_getIndex(store, handle);
+  if (index == ENTITY_NONE) {
+    return false;
+  }
+  entity_killIndex(store, index);
+  return true;
+}
+
+void entity_killAged(entity_store_t *store, uint8_t maxAge) {
+  for (uint16_t i = 0; i < store->count; i++) {
+    if (store->age[i] >= maxAge && !(store->flags[i] & ENTITY_FLAG_DEAD)) {
+      entity_killIndex(store, i);
+    }
+  }
+}
+
+// Copy every component of entity from into slot to.
+static void entity_copy(entity_store_t *store, uint16_t to, uint16_t from) {
+  store->x[to] = store->x[from];
+  store->y[to] = store->y[from];
+  store->previousX[to] = store->previousX[from];
+  store->previousY[to] = store->previousY[from];
+  store->xVelocity[to] = store->xVelocity[from];
+  store->yVelocity[to] = store->yVelocity[from];
+  store->radius[to] = store->radius[from];
+  store->age[to] = store->age[from];
+  store->flags[to] = store->flags[from];
+  store->id[to] = store->id[from];
+}
+
+// Retire the killed ids first, so their handles stay refused once the slots
+// are reused, and find where packing has to start. Slots below the first
+// kill do not move.
+void entity_flush(entity_store_t *store) {
+  if (store->killCount == 0) {
+    return;
+  }
+  uint16_t first = store->count;
+  for (uint16_t k = 0; k < store->killCount; k++) {
+    uint16_t index = store->kills[k];
+    uint16_t id = store->id[index];
+    store->generation[id]++;
+    store->freeIds[store->freeIdCount++] = id;
+    if (index < first) {
+      first = index;
+    }
+  }
+  store->killCount = 0;
+
+  uint16_t kept = first;
+  for (uint16_t i = first; i < store->count; i++) {
+    if (!(store->flags[i] & ENTITY_FLAG_DEAD)) {
+      if (kept != i) {
+        entity_copy(store, kept, i);
+        store->slot[store->id[kept]] = kept;
+      }
+      kept++;
+    }
+  }
+  store->count = kept;
+}
+
+// Retire every id in the store, so that ids can be handed out again from 0.
+// Ids already in freeIds were retired when they were flushed.
+void entity_clear(entity_store_t *store) {
+  for (uint16_t i = 0; i < store->count; i++) {
+    store->generation[store->id[i]]++;
+  }
+  store->count = 0;
+  store->killCount = 0;
+  store->freeIdCount = 0;
+  store->idCount = 0;
+}
+
+// Move entities [begin, end) of the store in context by one tick. An axis
+// that wrapped jumps across the screen, so it is not interpolated.
+static void entity_moveRange(uint16_t begin, uint16_t end, void *context) {
+  entity_store_t *store = context;
+  uint16_t count = end - begin;
+  memcpy(&store->previousX[begin], &store->x[begin],
+         count * sizeof store->x[0]);
+  memcpy(&store->previousY[begin], &store->y[begin],
+         count * sizeof store->y[0]);
+  motion_wrapAxis(&store->x[begin], &store->xVelocity[begin],
+                  &store->radius[begin], count, DISPLAY_WIDTH);
+  motion_wrapAxis(&store->y[begin], &store->yVelocity[begin],
+                  &store->radius[begin], count, DISPLAY_HEIGHT);
+  for (uint16_t i = begin; i < end; i++) {
+    if (store->x[i] - store->previousX[i] != store->xVelocity[i]) {
+      store->previousX[i] = store->x[i];
+    }
+    if (store->y[i] - store->previousY[i] != store->yVelocity[i]) {
+      store->previousY[i] = store->y[i];
+    }
+  }
+}
+
+void entity_moveAll(entity_store_t *store) {
+  parallel_for(store->count, MOVE_GRAIN, entity_moveRange, store);
+}
+
+void entity_ageAll(entity_store_t *store) {
+  for (uint16_t i = 0; i < store->count; i++) {
+    if (store->age[i] < UINT8_MAX) {
+      store->age[i]++;
+    }
+  }
+}
+
+entity_view_t entity_getView(const entity_store_t *store) {
+  return (entity_view_t){.count = store->count,
+                         .x = store->x,
+                         .y = store->y,
+                         .previousX = store->previousX,
+                         .previousY = store->previousY,
+                         .xVelocity = store->xVelocity,
+                         .yVelocity = store->yVelocity,
+                         .radius = store->radius,
+                         .age = store->age,
+                         .flags = store->flags};
+}
+
+// Only slots in play count, one component array at a time.
+uint32_t entity_hashState(const entity_store_t *store, uint32_t hash) {
+  uint16_t count = store->count;
+  hash = stateHash_add(hash, &count, sizeof count);
+  hash = stateHash_add(hash, store->x, count * sizeof store->x[0]);
+  hash = stateHash_add(hash, store->y, count * sizeof store->y[0]);
+  hash = stateHash_add(hash, store->previousX,
+                       count * sizeof store->previousX[0]);
+  hash = stateHash_add(hash, store->previousY,
+                       count * sizeof store->previousY[0]);
+  hash = stateHash_add(hash, store->xVelocity,
+                       count * sizeof store->xVelocity[0]);
+  hash = stateHash_add(hash, store->yVelocity,
+                       count * sizeof store->yVelocity[0]);
+  hash = stateHash_add(hash, store->radius, count * sizeof store->radius[0]);
+  hash = stateHash_add(hash, store->age, count * sizeof store->age[0]);
+  return stateHash_add(hash, store->flags, count * sizeof store->flags[0]);
+}
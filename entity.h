@@ -0,0 +1,155 @@
+#ifndef ENTITY_H_
+#define ENTITY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bits of the flags component.
+#define ENTITY_FLAG_COLLISION 0x01
+#define ENTITY_FLAG_DEAD 0x80 // Killed, waiting for entity_flush.
+
+// Returned by entity_getIndex for a handle that no longer names an entity.
+#define ENTITY_NONE UINT16_MAX
+
+// A reference to one entity that stays good however the store is packed, and
+// is refused once the entity has been killed, even after its id is reused.
+// The low 16 bits are the entity's id and the high 16 bits the id's
+// generation when the handle was made; the generation goes up every time an
+// entity with that id dies. Pass handles, not indices, between modules.
+typedef uint32_t entity_handle_t;
+
+// Returned by entity_create when the store is full.
+#define ENTITY_HANDLE_NONE UINT32_MAX
+
+// A fixed-size pool of moving circles, kept as a structure of arrays: entry i
+// of every component array belongs to the same entity, and entries
+// [0, count) are in the store. Entities are removed by killing them, which
+// only queues them; entity_flush takes them all out in one pass that packs
+// the survivors down in order. Indices are only good until the next flush,
+// and killed entities keep their slots until then.
+// Every kind of object in play (asteroids, lasers) is one of these, so the
+// move kernel, the broadphase and the state hash work on all of them.
+//
+// Declare a store with ENTITY_STORE rather than filling this in by hand.
+typedef struct {
+  uint16_t capacity;
+  uint16_t count;
+  uint16_t highWaterMark;     // Most entities alive at once since init.
+  uint32_t failedCreateCount; // Creates refused because the store was full.
+  uint16_t killCount;         // Entries of kills waiting for entity_flush.
+  uint16_t freeIdCount;       // Entries of freeIds ready for reuse.
+  uint16_t idCount;           // Ids handed out since the store was cleared.
+  int16_t *x;
+  int16_t *y;
+  // Where each entity was before the last move, for drawing frames between
+  // ticks and sweeping collisions. An axis that wrapped holds the new
+  // position instead.
+  int16_t *previousX;
+  int16_t *previousY;
+  int8_t *xVelocity;
+  int8_t *yVelocity;
+  uint8_t *radius;
+  uint8_t *age; // Ticks since creation, saturating.
+  uint8_t *flags;
+  uint16_t *id;         // Id of the entity in each slot.
+  uint16_t *slot;       // Slot holding each id's entity.
+  uint16_t *generation; // Each id's generation.
+  uint16_t *freeIds;    // Ids whose entities have been flushed.
+  uint16_t *kills;      // Slots killed since the last flush.
+} entity_store_t;
+
+// Read-only access to the entities alive in a store. Indices are the store's.
+typedef struct {
+  uint16_t count;
+  const int16_t *x;
+  const int16_t *y;
+  const int16_t *previousX;
+  const int16_t *previousY;
+  const int8_t *xVelocity;
+  const int8_t *yVelocity;
+  const uint8_t *radius;
+  const uint8_t *age;
+  const uint8_t *flags;
+} entity_view_t;
+
+// Define a static store called name with room for capacity entities, and the
+// statically allocated component arrays behind it. Use at file scope.
+#define ENTITY_STORE(name, entityCapacity)                                     \
+  static int16_t name##X[entityCapacity];                                      \
+  static int16_t name##Y[entityCapacity];                                      \
+  static int16_t name##PreviousX[entityCapacity];                              \
+  static int16_t name##PreviousY[entityCapacity];                              \
+  static int8_t name##XVelocity[entityCapacity];                               \
+  static int8_t name##YVelocity[entityCapacity];                               \
+  static uint8_t name##Radius[entityCapacity];                                 \
+  static uint8_t name##Age[entityCapacity];                                    \
+  static uint8_t name##Flags[entityCapacity];                                  \
+  static uint16_t name##Id[entityCapacity];                                    \
+  static uint16_t name##Slot[entityCapacity];                                  \
+  static uint16_t name##Generation[entityCapacity];                            \
+  static uint16_t name##FreeIds[entityCapacity];                               \
+  static uint16_t name##Kills[entityCapacity];                                 \
+  static entity_store_t name = {.capacity = (entityCapacity),                  \
+                                .x = name##X,                                  \
+                                .y = name##Y,                                  \
+                                .previousX = name##PreviousX,                  \
+                                .previousY = name##PreviousY,                  \
+                                .xVelocity = name##XVelocity,                  \
+                                .yVelocity = name##YVelocity,                  \
+                                .radius = name##Radius,                        \
+                                .age = name##Age,                              \
+                                .flags = name##Flags,                          \
+                                .id = name##Id,                                \
+                                .slot = name##Slot,                            \
+                                .generation = name##Generation,                \
+                                .freeIds = name##FreeIds,                      \
+                                .kills = name##Kills}
+
+// Empty the store and clear its high-water mark and failure count.
+void entity_init(entity_store_t *store);
+
+// Append an entity that has not moved yet, with age and flags cleared.
+// Returns its handle, or ENTITY_HANDLE_NONE without adding anything when the
+// store is full. Killed entities hold their slots until entity_flush.
+entity_handle_t entity_create(entity_store_t *store, int16_t x, int16_t y,
+                              int8_t xVelocity, int8_t yVelocity,
+                              uint8_t radius);
+
+// Handle of the entity at index, or ENTITY_HANDLE_NONE past the end.
+entity_handle_t entity_getHandle(const entity_store_t *store, uint16_t index);
+
+// Index of the entity handle names, or ENTITY_NONE if it has been killed.
+uint16_t entity_getIndex(const entity_store_t *store, entity_handle_t handle);
+
+// Queue the entity for removal at the next entity_flush. It keeps its slot
+// and components until then, but its handle is refused straight away, so
+// killing it twice is harmless. Returns false if handle was already refused.
+bool entity_kill(entity_store_t *store, entity_handle_t handle);
+
+// Kill every entity at least maxAge ticks old.
+void entity_killAged(entity_store_t *store, uint8_t maxAge);
+
+// Remove every killed entity in one pass: the survivors from the first
+// killed slot on are packed down in order, so entities created in order stay
+// oldest first. Call once per tick, after the kills and before anything reads
+// the store by index.
+void entity_flush(entity_store_t *store);
+
+// Remove every entity at once. Every handle to them is refused from then on.
+void entity_clear(entity_store_t *store);
+
+// Move every entity by one tick with motion_wrapAxis, wrapping at the screen
+// edges. Each entity only touches its own slots, so ranges of the store are
+// split across threads (see parallel.h).
+void entity_moveAll(entity_store_t *store);
+
+// Add a tick to every entity's age.
+void entity_ageAll(entity_store_t *store);
+
+entity_view_t entity_getView(const entity_store_t *store);
+
+// Fold every component of the entities alive into hash (see stateHash.h) and
+// return the result.
+uint32_t entity_hashState(const entity_store_t *store, uint32_t hash);
+
+#endif /* ENTITY_H_ */
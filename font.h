@@ -0,0 +1,19 @@
+#ifndef FONT_H_
+#define FONT_H_
+
+#include <stdint.h>
+
+// The classic 5x7 font the display driver uses. Each glyph is 5 columns of 8
+// bits with bit 0 at the top; at text size s a character takes a
+// DISPLAY_CHAR_WIDTH * s by DISPLAY_CHAR_HEIGHT * s cell (6x8 at size 1, the
+// extra column and row being spacing).
+#define FONT_GLYPH_COLUMNS 5
+#define FONT_GLYPH_ROWS 8
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR '~'
+
+// Return the 5 column bytes for c. Characters outside the printable ASCII
+// range come back blank.
+const uint8_t *font_getGlyph(char c);
+
+#endif /* FONT_H_ */
@@ -0,0 +1,473 @@
+#include "framebuffer.h"
+#include "config.h"
+#include "display.h"
+#include "font.h"
+#include "text.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BACKGROUND_COLOR DISPLAY_BLACK
+
+#if CONFIG_FRAMEBUFFER_DOUBLE_BUFFER
+#define BUFFER_COUNT 2
+#else
+#define BUFFER_COUNT 1
+#endif
+
+typedef uint16_t row_t[FRAMEBUFFER_WIDTH];
+
+// With double buffering the second buffer is a copy of what the panel
+// currently shows, so present can skip pixels that have not changed.
+static row_t buffers[BUFFER_COUNT][FRAMEBUFFER_HEIGHT];
+static row_t *backBuffer = buffers[0];
+#if CONFIG_FRAMEBUFFER_DOUBLE_BUFFER
+static row_t *frontBuffer = buffers[1];
+#endif
+
+// Inclusive on x0/y0 and exclusive on x1/y1.
+typedef struct {
+  int16_t x0;
+  int16_t y0;
+  int16_t x1;
+  int16_t y1;
+} region_t;
+
+static region_t dirtyRegions[FRAMEBUFFER_MAX_DIRTY_RECTS];
+static uint16_t dirtyCount;
+static bool wholeScreenDirty;
+
+static framebuffer_stats_t stats;
+
+#if CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+#define CIRCLE_TABLE_RADIUS CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS
+#if CIRCLE_TABLE_RADIUS > 31
+#error "circle tables are built in 64-bit rows, so the radius must be <= 31"
+#endif
+// Room for every table up to CIRCLE_TABLE_RADIUS: a filled circle has one
+// span per row, and an outline at most eight points per midpoint step.
+#define FILL_SPAN_COUNT ((CIRCLE_TABLE_RADIUS + 1) * (CIRCLE_TABLE_RADIUS + 1))
+#define OUTLINE_POINT_COUNT                                                    \
+  (4 * (CIRCLE_TABLE_RADIUS + 1) * (CIRCLE_TABLE_RADIUS + 2))
+
+// One horizontal run of a filled circle, relative to its centre.
+typedef struct {
+  int8_t dy;
+  int8_t dx;
+  uint8_t length;
+} span_t;
+
+// One pixel of an outline, relative to its centre. Outlines are mostly
+// single pixels per row, which are cheaper to plot than to loop over as runs.
+typedef struct {
+  int8_t dy;
+  int8_t dx;
+} point_t;
+
+// The spans of radius r are fillSpans[fillStart[r]] up to
+// fillSpans[fillStart[r + 1]], top row first, and likewise for outlines.
+static span_t fillSpans[FILL_SPAN_COUNT];
+static uint16_t fillStart[CIRCLE_TABLE_RADIUS + 2];
+static point_t outlinePoints[OUTLINE_POINT_COUNT];
+static uint16_t outlineStart[CIRCLE_TABLE_RADIUS + 2];
+// Largest radius with both tables built. Larger circles use the midpoint
+// routines.
+static int16_t tableRadius = -1;
+#endif
+
+#if CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+// Turn the bitmaps of radius r (bit r of each row is the centre column) into
+// its table entries. Returns false if they do not fit.
+static bool framebuffer_addCircle(int16_t r, const uint64_t *outline,
+                                  const uint64_t *fill) {
+  uint16_t points = outlineStart[r];
+  uint16_t spans = fillStart[r];
+  for (int16_t row = 0; row <= 2 * r; row++) {
+    for (uint64_t mask = outline[row]; mask != 0; mask &= mask - 1) {
+      if (points == OUTLINE_POINT_COUNT) {
+        return false;
+      }
+      outlinePoints[points++] =
+          (point_t){.dy = row - r, .dx = __builtin_ctzll(mask) - r};
+    }
+    // A filled circle is convex, so each row is one run.
+    uint8_t start = __builtin_ctzll(fill[row]);
+    uint8_t length = __builtin_ctzll(~(fill[row] >> start));
+    fillSpans[spans++] =
+        (span_t){.dy = row - r, .dx = start - r, .length = length};
+  }
+  outlineStart[r + 1] = points;
+  fillStart[r + 1] = spans;
+  return true;
+}
+
+// Rasterize every radius up to CIRCLE_TABLE_RADIUS once with the same
+// midpoint steps as the routines below, and keep the result as tables.
+static void framebuffer_buildCircleTables() {
+  uint64_t outline[2 * CIRCLE_TABLE_RADIUS + 1];
+  uint64_t fill[2 * CIRCLE_TABLE_RADIUS + 1];
+  outlineStart[0] = 0;
+  fillStart[0] = 0;
+  tableRadius = -1;
+  for (int16_t r = 0; r <= CIRCLE_TABLE_RADIUS; r++) {
+    memset(outline, 0, sizeof outline);
+    memset(fill, 0, sizeof fill);
+    int16_t f = 1 - r;
+    int16_t ddFx = 1;
+    int16_t ddFy = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    // Row r + dy, column r + dx.
+#define PLOT(dx, dy) (outline[r + (dy)] |= 1ull << (r + (dx)))
+    PLOT(0, r), PLOT(0, -r), PLOT(r, 0), PLOT(-r, 0);
+    for (int16_t row = -r; row <= r; row++) {
+      fill[r + row] |= 1ull << r;
+    }
+    while (x < y) {
+      if (f >= 0) {
+        y--;
+        ddFy += 2;
+        f += ddFy;
+      }
+      x++;
+      ddFx += 2;
+      f += ddFx;
+      PLOT(x, y), PLOT(-x, y), PLOT(x, -y), PLOT(-x, -y);
+      PLOT(y, x), PLOT(-y, x), PLOT(y, -x), PLOT(-y, -x);
+      // The fill's vertical lines at columns +-x span rows +-y, and at
+      // columns +-y rows +-x.
+      for (int16_t row = -y; row <= y; row++) {
+        fill[r + row] |= (1ull << (r + x)) | (1ull << (r - x));
+      }
+      for (int16_t row = -x; row <= x; row++) {
+        fill[r + row] |= (1ull << (r + y)) | (1ull << (r - y));
+      }
+    }
+#undef PLOT
+    if (!framebuffer_addCircle(r, outline, fill)) {
+      return;
+    }
+    tableRadius = r;
+  }
+}
+
+// True if a circle of radius r centred on (x0, y0) needs no clipping.
+static bool framebuffer_circleOnScreen(int16_t x0, int16_t y0, int16_t r) {
+  return x0 >= r && x0 < FRAMEBUFFER_WIDTH - r && y0 >= r &&
+         y0 < FRAMEBUFFER_HEIGHT - r;
+}
+
+// Plot an outline from its table, clipped to the screen.
+static void framebuffer_blitOutline(int16_t x0, int16_t y0, int16_t r,
+                                    uint16_t color) {
+  const point_t *point = &outlinePoints[outlineStart[r]];
+  const point_t *end = &outlinePoints[outlineStart[r + 1]];
+  if (framebuffer_circleOnScreen(x0, y0, r)) {
+    uint16_t *centre = &backBuffer[y0][x0];
+    for (; point < end; point++) {
+      centre[point->dy * FRAMEBUFFER_WIDTH + point->dx] = color;
+    }
+    return;
+  }
+  for (; point < end; point++) {
+    framebuffer_drawPixel(x0 + point->dx, y0 + point->dy, color);
+  }
+}
+
+// Fill a circle from its table one row at a time, clipped to the screen.
+static void framebuffer_blitFill(int16_t x0, int16_t y0, int16_t r,
+                                 uint16_t color) {
+  const span_t *span = &fillSpans[fillStart[r]];
+  const span_t *end = &fillSpans[fillStart[r + 1]];
+  bool onScreen = framebuffer_circleOnScreen(x0, y0, r);
+  for (; span < end; span++) {
+    int16_t y = y0 + span->dy;
+    int16_t x = x0 + span->dx;
+    int16_t x1 = x + span->length;
+    if (!onScreen) {
+      if (y < 0 || y >= FRAMEBUFFER_HEIGHT) {
+        continue;
+      }
+      x = x < 0 ? 0 : x;
+      x1 = x1 > FRAMEBUFFER_WIDTH ? FRAMEBUFFER_WIDTH : x1;
+    }
+    uint16_t *row = backBuffer[y];
+    for (; x < x1; x++) {
+      row[x] = color;
+    }
+  }
+}
+#endif
+
+// Clear the framebuffer(s) and the display to black.
+void framebuffer_init() {
+  for (uint8_t b = 0; b < BUFFER_COUNT; b++) {
+    for (int16_t y = 0; y < FRAMEBUFFER_HEIGHT; y++) {
+      for (int16_t x = 0; x < FRAMEBUFFER_WIDTH; x++) {
+        buffers[b][y][x] = BACKGROUND_COLOR;
+      }
+    }
+  }
+  display_fillScreen(BACKGROUND_COLOR);
+#if CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+  framebuffer_buildCircleTables();
+#endif
+  dirtyCount = 0;
+  wholeScreenDirty = false;
+  memset(&stats, 0, sizeof stats);
+}
+
+void framebuffer_drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x >= 0 && x < FRAMEBUFFER_WIDTH && y >= 0 && y < FRAMEBUFFER_HEIGHT) {
+    backBuffer[y][x] = color;
+  }
+}
+
+void framebuffer_drawFastHLine(int16_t x, int16_t y, int16_t w,
+                               uint16_t color) {
+  framebuffer_fillRect(x, y, w, 1, color);
+}
+
+static void framebuffer_drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                      uint16_t color) {
+  framebuffer_fillRect(x, y, 1, h, color);
+}
+
+void framebuffer_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color) {
+  int16_t x1 = x + w;
+  int16_t y1 = y + h;
+  x = x < 0 ? 0 : x;
+  y = y < 0 ? 0 : y;
+  x1 = x1 > FRAMEBUFFER_WIDTH ? FRAMEBUFFER_WIDTH : x1;
+  y1 = y1 > FRAMEBUFFER_HEIGHT ? FRAMEBUFFER_HEIGHT : y1;
+  for (int16_t row = y; row < y1; row++) {
+    for (int16_t col = x; col < x1; col++) {
+      backBuffer[row][col] = color;
+    }
+  }
+}
+
+// Bresenham's line, stepping along the longer axis like the display does.
+void framebuffer_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int16_t temp;
+  if (steep) {
+    temp = x0, x0 = y0, y0 = temp;
+    temp = x1, x1 = y1, y1 = temp;
+  }
+  if (x0 > x1) {
+    temp = x0, x0 = x1, x1 = temp;
+    temp = y0, y0 = y1, y1 = temp;
+  }
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) {
+      framebuffer_drawPixel(y0, x0, color);
+    } else {
+      framebuffer_drawPixel(x0, y0, color);
+    }
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+// Midpoint circle, plotting the eight symmetric points of each step, or the
+// same pixels from the span table for small radii.
+void framebuffer_drawCircle(int16_t x0, int16_t y0, int16_t r,
+                            uint16_t color) {
+#if CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+  if (r >= 0 && r <= tableRadius) {
+    framebuffer_blitOutline(x0, y0, r, color);
+    return;
+  }
+#endif
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  framebuffer_drawPixel(x0, y0 + r, color);
+  framebuffer_drawPixel(x0, y0 - r, color);
+  framebuffer_drawPixel(x0 + r, y0, color);
+  framebuffer_drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    framebuffer_drawPixel(x0 + x, y0 + y, color);
+    framebuffer_drawPixel(x0 - x, y0 + y, color);
+    framebuffer_drawPixel(x0 + x, y0 - y, color);
+    framebuffer_drawPixel(x0 - x, y0 - y, color);
+    framebuffer_drawPixel(x0 + y, y0 + x, color);
+    framebuffer_drawPixel(x0 - y, y0 + x, color);
+    framebuffer_drawPixel(x0 + y, y0 - x, color);
+    framebuffer_drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+// Filled midpoint circle, drawn as vertical lines, or as rows from the span
+// table for small radii.
+void framebuffer_fillCircle(int16_t x0, int16_t y0, int16_t r,
+                            uint16_t color) {
+#if CONFIG_FRAMEBUFFER_CIRCLE_TABLE_RADIUS > 0
+  if (r >= 0 && r <= tableRadius) {
+    framebuffer_blitFill(x0, y0, r, color);
+    return;
+  }
+#endif
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  framebuffer_drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    framebuffer_drawFastVLine(x0 + x, y0 - y, 2 * y + 1, color);
+    framebuffer_drawFastVLine(x0 + y, y0 - x, 2 * x + 1, color);
+    framebuffer_drawFastVLine(x0 - x, y0 - y, 2 * y + 1, color);
+    framebuffer_drawFastVLine(x0 - y, y0 - x, 2 * x + 1, color);
+  }
+}
+
+// Draw a cached glyph one run of set pixels at a time: each run of a row is
+// a single size-pixel-tall rectangle.
+void framebuffer_drawChar(int16_t x, int16_t y, uint8_t size, char c,
+                          uint16_t color) {
+  const text_glyph_t *glyph = text_getGlyph(c, size);
+  for (int16_t row = 0; row < FONT_GLYPH_ROWS; row++) {
+    uint32_t mask = glyph->rows[row];
+    while (mask != 0) {
+      uint8_t start = __builtin_ctz(mask);
+      uint8_t length = __builtin_ctz(~(mask >> start));
+      framebuffer_fillRect(x + start, y + row * size, length, size, color);
+      mask &= ~(((1u << length) - 1) << start);
+    }
+  }
+}
+
+// Draw text like display_print, including its wrap at the right edge.
+void framebuffer_drawText(int16_t x, int16_t y, uint8_t size, const char *str,
+                          uint16_t color) {
+  int16_t cursorX = x;
+  int16_t cursorY = y;
+  for (; *str != '\0'; str++) {
+    if (*str == '\n') {
+      cursorX = 0;
+      cursorY += size * DISPLAY_CHAR_HEIGHT;
+      continue;
+    }
+    framebuffer_drawChar(cursorX, cursorY, size, *str, color);
+    cursorX += size * DISPLAY_CHAR_WIDTH;
+    if (cursorX > FRAMEBUFFER_WIDTH - size * DISPLAY_CHAR_WIDTH) {
+      cursorX = 0;
+      cursorY += size * DISPLAY_CHAR_HEIGHT;
+    }
+  }
+}
+
+// Note that a region of the framebuffer changed.
+void framebuffer_markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  if (wholeScreenDirty) {
+    return;
+  }
+  if (dirtyCount == FRAMEBUFFER_MAX_DIRTY_RECTS) {
+    wholeScreenDirty = true;
+    return;
+  }
+  region_t region = {.x0 = x < 0 ? 0 : x,
+                     .y0 = y < 0 ? 0 : y,
+                     .x1 = x + w > FRAMEBUFFER_WIDTH ? FRAMEBUFFER_WIDTH
+                                                     : x + w,
+                     .y1 = y + h > FRAMEBUFFER_HEIGHT ? FRAMEBUFFER_HEIGHT
+                                                      : y + h};
+  if (region.x0 < region.x1 && region.y0 < region.y1) {
+    dirtyRegions[dirtyCount++] = region;
+  }
+}
+
+// Send one region to the display as runs of same-colored pixels. With double
+// buffering, pixels the panel already shows are skipped, which also ends a
+// run, and the copy of the panel is brought up to date.
+static void framebuffer_flushRegion(region_t region) {
+  for (int16_t y = region.y0; y < region.y1; y++) {
+    const uint16_t *row = backBuffer[y];
+    int16_t x = region.x0;
+    while (x < region.x1) {
+#if CONFIG_FRAMEBUFFER_DOUBLE_BUFFER
+      uint16_t *shown = frontBuffer[y];
+      if (row[x] == shown[x]) {
+        x++;
+        continue;
+      }
+#endif
+      int16_t start = x;
+      uint16_t color = row[x];
+#if CONFIG_FRAMEBUFFER_DOUBLE_BUFFER
+      while (x < region.x1 && row[x] == color && shown[x] != color) {
+        shown[x] = color;
+        x++;
+      }
+#else
+      while (x < region.x1 && row[x] == color) {
+        x++;
+      }
+#endif
+      display_drawFastHLine(start, y, x - start, color);
+      stats.framePixels += x - start;
+      stats.frameRuns++;
+    }
+  }
+}
+
+// Send the changed regions to the display.
+void framebuffer_present() {
+  stats.framePixels = 0;
+  stats.frameRuns = 0;
+  if (!CONFIG_FRAMEBUFFER_PARTIAL_FLUSH || wholeScreenDirty) {
+    framebuffer_flushRegion((region_t){.x0 = 0,
+                                       .y0 = 0,
+                                       .x1 = FRAMEBUFFER_WIDTH,
+                                       .y1 = FRAMEBUFFER_HEIGHT});
+  } else {
+    for (uint16_t i = 0; i < dirtyCount; i++) {
+      framebuffer_flushRegion(dirtyRegions[i]);
+    }
+  }
+  dirtyCount = 0;
+  wholeScreenDirty = false;
+  stats.totalPixels += stats.framePixels;
+  stats.totalRuns += stats.frameRuns;
+}
+
+uint16_t framebuffer_getPixel(int16_t x, int16_t y) {
+  if (x >= 0 && x < FRAMEBUFFER_WIDTH && y >= 0 && y < FRAMEBUFFER_HEIGHT) {
+    return backBuffer[y][x];
+  }
+  return BACKGROUND_COLOR;
+}
+
+framebuffer_stats_t framebuffer_getStats() { return stats; }
@@ -0,0 +1,60 @@
+#ifndef FRAMEBUFFER_H_
+#define FRAMEBUFFER_H_
+
+#include <display.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FRAMEBUFFER_WIDTH DISPLAY_WIDTH
+#define FRAMEBUFFER_HEIGHT DISPLAY_HEIGHT
+
+// Regions that can be marked dirty between presents. Past this the whole
+// screen is flushed.
+#define FRAMEBUFFER_MAX_DIRTY_RECTS 48
+
+// Counters for the bus traffic of present. A run is one horizontal line sent
+// to the display.
+typedef struct {
+  uint32_t framePixels;
+  uint32_t frameRuns;
+  uint64_t totalPixels;
+  uint64_t totalRuns;
+} framebuffer_stats_t;
+
+// Clear the framebuffer(s) and the display to black.
+void framebuffer_init();
+
+// Drawing primitives. They write to memory only, clip to the screen and
+// produce the same pixels as the display routines of the same name.
+void framebuffer_drawPixel(int16_t x, int16_t y, uint16_t color);
+void framebuffer_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+void framebuffer_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color);
+void framebuffer_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                          uint16_t color);
+void framebuffer_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void framebuffer_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+
+// Draw one character cell with its top left corner at (x, y), from the
+// glyph cache (see text.h). The background is left alone.
+void framebuffer_drawChar(int16_t x, int16_t y, uint8_t size, char c,
+                          uint16_t color);
+
+// Draw text with its top left corner at (x, y) using the display font, with a
+// transparent background like display_print.
+void framebuffer_drawText(int16_t x, int16_t y, uint8_t size, const char *str,
+                          uint16_t color);
+
+// Note that a region of the framebuffer changed and must go to the display on
+// the next present.
+void framebuffer_markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+
+// Send the changed regions to the display. Call once at the end of a tick.
+void framebuffer_present();
+
+// Read back a pixel of the frame being drawn.
+uint16_t framebuffer_getPixel(int16_t x, int16_t y);
+
+framebuffer_stats_t framebuffer_getStats();
+
+#endif /* FRAMEBUFFER_H_ */
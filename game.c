@@ -1,12 +1,22 @@
 #include "game.h"
 #include "asteroid.h"
+#include "collision.h"
+#include "config.h"
 #include "display.h"
 #include "laser.h"
+#include "logger.h"
+#include "parallel.h"
+#include "random.h"
+#include "render.h"
+#include "scheduler.h"
+#include "input.h"
 #include "spaceship.h"
+#include "stateHash.h"
+#include "text.h"
 
-#include <buttons.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // include button masks for ship controls
@@ -37,28 +47,18 @@
 #define LIVES_X SCORE_TEXT_SIZE
 #define LIVES_Y SCORE_TEXT_SIZE * 10
 #define LIVES_SIZE SCORE_TEXT_SIZE
-#define MAX_SCORE_SIZE 10
-
-#define INIT_ST_MSG "game_init_st\n"
-#define WELCOME_ST_MSG "game_welcome_st\n"
-#define WELCOME_ADC_ST_MSG "game_welcome_adc_st\n"
-#define PLAY_ST_MSG "game_play_st\n"
-#define NEXT_LEVEL_ST_MSG "game_next_level_st\n"
-#define DEATH_ST_MSG "game_death_st\n"
-#define GAME_OVER_ST_MSG "game_over_st\n"
-#define PLAY_AGAIN_ST_MSG "game_play_again_st\n"
-#define PLAY_AGAIN_ADC_ST_MSG "game_play_again_adc_st\n"
-#define ERROR_ST_MSG "game_error_st\n"
-#define NUM_CHECK_POINTS (NUM_VERTICIES + 1)
+#define SCORE_REDRAW_COST_US 50 // Rough cost of formatting the score.
+
 #define ASTEROID_SCORE_POINTS 100
+// Fewest lasers one thread tests at a time (see parallel.h). Each test is a
+// grid query, which gets expensive when asteroids are dense.
+#define LASER_TEST_GRAIN 8
 
-#define CONFIG_TIMER_PERIOD .1
-#define ADC_COUNTER_MAX 1
 #define REFRESH_COUNTER_MAX 2
-#define DEATH_COUNTER_MAX 2 / CONFIG_TIMER_PERIOD
-#define NEXT_LEVEL_COUNTER_MAX 2 / CONFIG_TIMER_PERIOD
-#define GAME_OVER_COUNTER_MAX 2 / CONFIG_TIMER_PERIOD
-#define PLAY_AGAIN_COUNTER_MAX 2 / CONFIG_TIMER_PERIOD
+#define DEATH_COUNTER_MAX 2 / CONFIG_TICK_PERIOD
+#define NEXT_LEVEL_COUNTER_MAX 2 / CONFIG_TICK_PERIOD
+#define GAME_OVER_COUNTER_MAX 2 / CONFIG_TICK_PERIOD
+#define PLAY_AGAIN_COUNTER_MAX 2 / CONFIG_TICK_PERIOD
 
 #define FIRE_BTN_NUM 3
 #define RIGHT_BTN_NUM 2
@@ -71,103 +71,118 @@
 
 #define SQUARE_TERMS(A) ((A) * (A))
 
-static uint16_t adcCounter;
 static uint16_t deathCounter;
 static uint16_t nextLevelCounter;
 static uint16_t gameOverCounter;
 static uint16_t playAgainCounter;
 static uint16_t refreshCounter;
 static uint8_t level;
+static uint16_t gameCount; // Games started since game_init.
 static uint8_t lives = 0;
 static uint16_t score = 0;
+static bool scoreShown;
+static char livesStr[MAX_LIVES + 1]; // MAX_LIVES copies of LIFE_CHAR.
 static uint16_t msPerTick;
 static bool enabled;
+// This tick's lasers, and for each one how many asteroids its path touched
+// and the first of them.
+static entity_view_t testLasers;
+static uint16_t laserHitCount[MAX_LASER_COUNT];
+static uint16_t laserFirstHit[MAX_LASER_COUNT];
 
 static enum game_st_t {
   init_st,
   welcome_st,
-  welcome_adc_st,
   play_st,
   next_level_st,
   death_st,
   game_over_st,
-  play_again_st,
-  play_again_adc_st
+  play_again_st
 } currentState,
     nextState;
 
+// Text items this module keeps in the render stage.
+enum game_textSlot_t {
+  title_slot,
+  touch_slot,
+  score_slot,
+  lives_slot,
+  gameOver_slot,
+  playAgain_slot
+};
+
+// The screens and HUD are retained text items in the render stage. Drawing
+// sets an item and erasing clears it; the render stage repaints whatever
+// changed once per frame.
 void game_drawWelcome(bool draw) {
   if (draw) {
-    display_setTextColor(DISPLAY_WHITE);
+    render_setText(title_slot, TITLE_TEXT_X, TITLE_TEXT_Y, TITLE_TEXT_SIZE,
+                   TITLE_TEXT);
+    render_setText(touch_slot, TOUCH_TEXT_X, TOUCH_TEXT_Y, TOUCH_TEXT_SIZE,
+                   TOUCH_TEXT);
   } else {
-    display_setTextColor(DISPLAY_BLACK);
+    render_clearText(title_slot);
+    render_clearText(touch_slot);
   }
-  display_setCursor(TITLE_TEXT_X, TITLE_TEXT_Y);
-  display_setTextSize(TITLE_TEXT_SIZE);
-  display_print(TITLE_TEXT);
-  display_setCursor(TOUCH_TEXT_X, TOUCH_TEXT_Y);
-  display_setTextSize(TOUCH_TEXT_SIZE);
-  display_print(TOUCH_TEXT);
 }
 
 void game_drawScore(bool draw) {
+  scoreShown = draw;
   if (draw) {
-    display_setTextColor(DISPLAY_WHITE);
+    char scoreStr[TEXT_MAX_DIGITS + 1];
+    text_formatUnsigned(score, scoreStr);
+    render_setText(score_slot, SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_SIZE,
+                   scoreStr);
   } else {
-    display_setTextColor(DISPLAY_BLACK);
+    render_clearText(score_slot);
   }
-  display_setCursor(SCORE_TEXT_X, SCORE_TEXT_Y);
-  display_setTextSize(SCORE_TEXT_SIZE);
-  char scoreStr[MAX_SCORE_SIZE];
-  sprintf(scoreStr, "%d", score);
-  display_print(scoreStr);
 }
 
+// One LIFE_CHAR per life: the tail of livesStr, so nothing is built per
+// call. Lives past MAX_LIVES are not shown.
 void game_drawLives(bool draw) {
   if (draw) {
-    display_setTextColor(DISPLAY_WHITE);
+    uint8_t shown = lives < MAX_LIVES ? lives : MAX_LIVES;
+    render_setText(lives_slot, LIVES_X, LIVES_Y, LIVES_SIZE,
+                   &livesStr[MAX_LIVES - shown]);
   } else {
-    display_setTextColor(DISPLAY_BLACK);
-  }
-  display_setCursor(LIVES_X, LIVES_Y);
-  display_setTextSize(LIVES_SIZE);
-  char str[MAX_LIVES + 1];
-  for (int i = 0; i <= lives; ++i) {
-    if (i == (lives)) {
-      str[i] = '\0';
-    } else {
-      str[i] = 'A';
-    }
+    render_clearText(lives_slot);
   }
-  display_print(str);
 }
 
 void game_drawGameOver(bool draw) {
   if (draw) {
-    display_setTextColor(DISPLAY_WHITE);
+    render_setText(gameOver_slot, GAME_OVER_TEXT_X, GAME_OVER_TEXT_Y,
+                   GAME_OVER_SIZE, GAME_OVER_TEXT);
   } else {
-    display_setTextColor(DISPLAY_BLACK);
+    render_clearText(gameOver_slot);
   }
-  display_setCursor(GAME_OVER_TEXT_X, GAME_OVER_TEXT_Y);
-  display_setTextSize(GAME_OVER_SIZE);
-  display_print(GAME_OVER_TEXT);
 }
 
 void game_drawPlayAgain(bool draw) {
   if (draw) {
-    display_setTextColor(DISPLAY_WHITE);
+    render_setText(playAgain_slot, PLAY_AGAIN_TEXT_X, PLAY_AGAIN_TEXT_Y,
+                   PLAY_AGAIN_TEXT_SIZE, PLAY_AGAIN_TEXT);
   } else {
-    display_setTextColor(DISPLAY_BLACK);
+    render_clearText(playAgain_slot);
   }
-  display_setCursor(PLAY_AGAIN_TEXT_X, PLAY_AGAIN_TEXT_Y);
-  display_setTextSize(PLAY_AGAIN_TEXT_SIZE);
-  display_print(PLAY_AGAIN_TEXT);
 }
 
+// Idle job that brings the HUD up to date with the score, unless the score
+// was taken off the screen since the job was posted.
+static void game_redrawScore() {
+  if (scoreShown) {
+    game_drawScore(true);
+  }
+}
+
+// The redraw is deferred to the slack after this tick, which is still before
+// the next frame is drawn, so several hits in one tick format the score once.
 void game_incrementScore(uint16_t points) {
-  game_drawScore(false);
   score = score + points;
-  game_drawScore(true);
+  if (!scheduler_post(game_redrawScore, 1, SCORE_REDRAW_COST_US)) {
+    game_redrawScore();
+  }
 }
 
 void game_changeLives(bool loseLife) {
@@ -181,8 +196,18 @@ void game_changeLives(bool loseLife) {
 }
 
 void game_init() {
+  memset(livesStr, LIFE_CHAR[0], MAX_LIVES);
+  livesStr[MAX_LIVES] = '\0';
+  currentState = init_st;
+  nextState = init_st;
+  deathCounter = 0;
+  nextLevelCounter = 0;
+  gameOverCounter = 0;
+  playAgainCounter = 0;
+  scoreShown = false;
   enabled = false;
   level = 1;
+  gameCount = 0;
   score = 0;
   refreshCounter = 0;
   lives = START_LIVES;
@@ -195,83 +220,151 @@ uint16_t game_getMsPerTick() { return msPerTick; }
 
 void game_shipControl() {}
 
-void game_checkLaserCollision() {
+// Find the asteroids the broadphase grid puts near the path laser travelled
+// this tick (see collision_queryGrid).
+static const uint16_t *game_laserCandidates(uint16_t laser, uint16_t *count) {
+  int16_t pathLength = abs(testLasers.x[laser] - testLasers.previousX[laser]) +
+                       abs(testLasers.y[laser] - testLasers.previousY[laser]);
+  return collision_queryGrid(testLasers.x[laser], testLasers.y[laser],
+                             testLasers.radius[laser] + pathLength, count);
+}
+
+static bool game_laserHits(uint16_t laser, uint16_t asteroid) {
+  return collision_segmentHitsAsteroid(
+      asteroid, testLasers.previousX[laser], testLasers.previousY[laser],
+      testLasers.x[laser], testLasers.y[laser], testLasers.radius[laser]);
+}
 
-  struct Asteroid *asteroid = asteroid_getHeadAsteroid();
-  while (asteroid != NULL) {
-    struct Laser *laser = laser_getHeadLaser();
-    while (laser != NULL) {
-      if ((SQUARE_TERMS(asteroid->x - laser->x) <
-           SQUARE_TERMS(asteroid->radius)) &&
-          (SQUARE_TERMS(asteroid->y - laser->y) <
-           SQUARE_TERMS(asteroid->radius))) {
-        asteroid->collision = true;
-        game_incrementScore(ASTEROID_SCORE_POINTS);
-        printf("laser collision\n");
+// Count the asteroids hit by lasers [begin, end). Only reads game state, so
+// the range can be split across threads.
+static void game_testLaserRange(uint16_t begin, uint16_t end, void *context) {
+  (void)context;
+  for (uint16_t i = begin; i < end; i++) {
+    uint16_t candidateCount;
+    const uint16_t *candidates = game_laserCandidates(i, &candidateCount);
+    laserHitCount[i] = 0;
+    for (uint16_t c = 0; c < candidateCount; c++) {
+      if (game_laserHits(i, candidates[c])) {
+        if (laserHitCount[i] == 0) {
+          laserFirstHit[i] = candidates[c];
+        }
+        laserHitCount[i]++;
       }
-      laser = laser->nextLaser;
     }
-    asteroid = asteroid->nextAsteroid;
   }
 }
 
-bool game_checkShipCollision() {
-  coordinates_t principlePoints[NUM_CHECK_POINTS];
-  spaceship_getPrinciplePoints(principlePoints);
-  for (int i = 0; i < NUM_CHECK_POINTS; ++i) {
-    coordinates_t coordinate = principlePoints[i];
-    struct Asteroid *asteroid = asteroid_getHeadAsteroid();
-    while (asteroid != NULL) {
-      if ((SQUARE_TERMS(asteroid->x - coordinate.x) <
-           SQUARE_TERMS(asteroid->radius)) &&
-          (SQUARE_TERMS(asteroid->y - coordinate.y) <
-           SQUARE_TERMS(asteroid->radius))) {
-        asteroid->collision = true;
-        game_changeLives(true);
-        printf("ship collision\n");
-        return true;
+static void game_laserHit(uint16_t asteroid) {
+  asteroid_markCollision(asteroid_getHandle(asteroid));
+  game_incrementScore(ASTEROID_SCORE_POINTS);
+  LOG_INFO(logger_laserCollision, asteroid, 0);
+}
+
+// Test the path every laser travelled this tick against the asteroids the
+// broadphase grid puts near that path. The tests run in parallel; the hits
+// are applied afterwards on this thread in firing order, so the score and the
+// log come out the same for any thread count. A laser that hit several
+// asteroids is tested again here to list them, which counts those tests
+// twice in the collision stats.
+void game_checkLaserCollision() {
+  testLasers = laser_getView();
+  parallel_for(testLasers.count, LASER_TEST_GRAIN, game_testLaserRange, NULL);
+  for (uint16_t i = 0; i < testLasers.count; i++) {
+    if (laserHitCount[i] == 1) {
+      game_laserHit(laserFirstHit[i]);
+    } else if (laserHitCount[i] > 1) {
+      uint16_t candidateCount;
+      const uint16_t *candidates = game_laserCandidates(i, &candidateCount);
+      for (uint16_t c = 0; c < candidateCount; c++) {
+        if (game_laserHits(i, candidates[c])) {
+          game_laserHit(candidates[c]);
+        }
       }
-      asteroid = asteroid->nextAsteroid;
     }
   }
-  return false;
+}
+
+// Test the ship's hull, swept along the distance it moved this tick, against
+// the asteroids the broadphase grid puts near the ship. One asteroid at most
+// is hit.
+bool game_checkShipCollision() {
+  collision_hull_t hull;
+  spaceship_getHull(&hull);
+  uint16_t candidateCount;
+  const uint16_t *candidates =
+      collision_queryGrid(hull.centerX, hull.centerY,
+                          hull.boundingRadius + abs(hull.dx) + abs(hull.dy),
+                          &candidateCount);
+  uint16_t hit;
+  if (collision_hullHitsAsteroids(&hull, candidates, candidateCount, &hit,
+                                  1) == 0) {
+    return false;
+  }
+  asteroid_markCollision(asteroid_getHandle(hit));
+  game_changeLives(true);
+  LOG_INFO(logger_shipCollision, hit, 0);
+  return true;
 }
 
 void game_debugState() {
   switch (currentState) {
   case init_st:
-    printf(INIT_ST_MSG);
+    LOG_DEBUG(logger_gameInitState, 0, 0);
     break;
   case welcome_st:
-    printf(WELCOME_ST_MSG);
-    break;
-  case welcome_adc_st:
-    printf(WELCOME_ADC_ST_MSG);
+    LOG_DEBUG(logger_gameWelcomeState, 0, 0);
     break;
   case play_st:
-    printf(PLAY_ST_MSG);
+    LOG_DEBUG(logger_gamePlayState, 0, 0);
     break;
   case next_level_st:
-    printf(NEXT_LEVEL_ST_MSG);
+    LOG_DEBUG(logger_gameNextLevelState, 0, 0);
     break;
   case death_st:
-    printf(DEATH_ST_MSG);
+    LOG_DEBUG(logger_gameDeathState, 0, 0);
     break;
   case game_over_st:
-    printf(GAME_OVER_ST_MSG);
+    LOG_DEBUG(logger_gameOverState, 0, 0);
     break;
   case play_again_st:
-    printf(PLAY_AGAIN_ST_MSG);
-    break;
-  case play_again_adc_st:
-    printf(PLAY_AGAIN_ADC_ST_MSG);
+    LOG_DEBUG(logger_gamePlayAgainState, 0, 0);
     break;
   default:
-    printf(ERROR_ST_MSG);
+    LOG_ERROR(logger_errorState, currentState, 0);
     break;
   }
 }
 
+// Seed for the asteroids of this level of this game. Every level of every
+// game gets its own, and the same game and level always play out the same.
+static uint32_t game_levelSeed() {
+  return random_deriveSeed(random_deriveSeed(CONFIG_RANDOM_SEED, gameCount),
+                           level);
+}
+
+// Start a new game: full lives, no score, and the ship and this level's
+// asteroids.
+static void game_startPlay() {
+  gameCount++;
+  score = 0;
+  lives = START_LIVES;
+  asteroid_enable();
+  laser_enable();
+  spaceship_enable();
+  game_drawScore(true);
+  game_drawLives(true);
+  asteroid_generateAsteroids(level, game_levelSeed());
+}
+
+// Skip the welcome screen and start playing startLevel.
+void game_startLevel(uint8_t startLevel) {
+  enabled = true;
+  level = startLevel;
+  game_startPlay();
+  currentState = play_st;
+  nextState = play_st;
+}
+
 // Standard tick function.
 void game_tick() {
   if (enabled) {
@@ -290,31 +383,12 @@ void game_tick() {
     if (!enabled) {
       game_drawWelcome(false);
       nextState = init_st;
-    } else if (display_isTouched()) {
-      nextState = welcome_adc_st;
-    } else {
-      nextState = welcome_st;
-    }
-    break;
-  case welcome_adc_st:
-    if (!enabled) {
-      game_drawWelcome(false);
-      nextState = init_st;
-    } else if (adcCounter >= ADC_COUNTER_MAX && display_isTouched()) {
-      adcCounter = 0;
+    } else if (input_getPressed() & INPUT_TOUCH) {
       game_drawWelcome(false);
-      asteroid_enable();
-      laser_enable();
-      spaceship_enable();
-      game_drawScore(true);
-      game_drawLives(true);
-      asteroid_generateAsteroids(level);
+      game_startPlay();
       nextState = play_st;
-    } else if (adcCounter >= ADC_COUNTER_MAX && !display_isTouched()) {
-      adcCounter = 0;
-      nextState = welcome_st;
     } else {
-      nextState = welcome_adc_st;
+      nextState = welcome_st;
     }
     break;
   case play_st:
@@ -339,6 +413,7 @@ void game_tick() {
         refreshCounter = 0;
       }
       game_shipControl();
+      collision_buildGrid(asteroid_getView());
       game_checkLaserCollision();
       bool shipCollide = game_checkShipCollision();
       if (shipCollide) {
@@ -367,7 +442,7 @@ void game_tick() {
       nextLevelCounter = 0;
       asteroid_enable();
       laser_enable();
-      asteroid_generateAsteroids(level);
+      asteroid_generateAsteroids(level, game_levelSeed());
       nextState = play_st;
     } else {
       nextState = next_level_st;
@@ -426,39 +501,21 @@ void game_tick() {
       game_drawPlayAgain(false);
       game_drawWelcome(true);
       nextState = welcome_st;
-    } else if (display_isTouched()) {
+    } else if (input_getPressed() & INPUT_TOUCH) {
       playAgainCounter = 0;
-      nextState = play_again_adc_st;
-    } else {
-      nextState = play_again_st;
-    }
-    break;
-  case play_again_adc_st:
-    if (!enabled) {
-      game_drawGameOver(false);
-      game_drawPlayAgain(false);
-      nextState = init_st;
-    } else if (adcCounter == ADC_COUNTER_MAX && display_isTouched()) {
-      adcCounter = 0;
       game_drawGameOver(false);
       game_drawPlayAgain(false);
       score = 0;
       lives = START_LIVES;
+      gameCount++;
       game_drawLives(true);
       game_drawScore(true);
       asteroid_enable();
       laser_enable();
       spaceship_enable();
       nextState = play_st;
-    } else if (adcCounter == ADC_COUNTER_MAX && !display_isTouched()) {
-      adcCounter = 0;
-      score = 0;
-      game_drawGameOver(false);
-      game_drawPlayAgain(false);
-      game_drawWelcome(true);
-      nextState = init_st;
     } else {
-      nextState = play_again_adc_st;
+      nextState = play_again_st;
     }
     break;
   default:
@@ -471,15 +528,11 @@ void game_tick() {
     refreshCounter = 0;
     deathCounter = 0;
     nextLevelCounter = 0;
-    adcCounter = 0;
     score = 0;
     playAgainCounter = 0;
     break;
   case welcome_st:
     break;
-  case welcome_adc_st:
-    adcCounter++;
-    break;
   case play_st:
     refreshCounter++;
     nextLevelCounter++;
@@ -496,9 +549,6 @@ void game_tick() {
   case play_again_st:
     playAgainCounter++;
     break;
-  case play_again_adc_st:
-    adcCounter++;
-    break;
   default:
     break;
   }
@@ -511,4 +561,20 @@ void game_enable() { enabled = true; }
 void game_disable() { enabled = false; }
 
 // Use this predicate to see if the game is finished.
-bool game_isGameOver() { return lives == 0; }
\ No newline at end of file
+bool game_isGameOver() { return lives == 0; }
+
+// Fold the game state into hash: the state machine, its counters and the
+// score.
+uint32_t game_hashState(uint32_t hash) {
+  hash = stateHash_add(hash, &currentState, sizeof currentState);
+  hash = stateHash_add(hash, &enabled, sizeof enabled);
+  hash = stateHash_add(hash, &deathCounter, sizeof deathCounter);
+  hash = stateHash_add(hash, &nextLevelCounter, sizeof nextLevelCounter);
+  hash = stateHash_add(hash, &gameOverCounter, sizeof gameOverCounter);
+  hash = stateHash_add(hash, &playAgainCounter, sizeof playAgainCounter);
+  hash = stateHash_add(hash, &refreshCounter, sizeof refreshCounter);
+  hash = stateHash_add(hash, &level, sizeof level);
+  hash = stateHash_add(hash, &gameCount, sizeof gameCount);
+  hash = stateHash_add(hash, &lives, sizeof lives);
+  return stateHash_add(hash, &score, sizeof score);
+}
\ No newline at end of file
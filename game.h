@@ -25,7 +25,25 @@ void game_enable();
 // Disable the state machine (interlock).
 void game_disable();
 
+// Enable the game and go straight to playing level, as if the welcome screen
+// had been touched. For benchmarks and other harnesses that need the game in
+// play without scripting input.
+void game_startLevel(uint8_t level);
+
+// Test the lasers' paths against the asteroids, scoring and flagging every
+// hit. game_tick runs this each tick in play, after building the collision
+// grid (see collision.h).
+void game_checkLaserCollision();
+
+// Test the ship's hull and path against the asteroids. Returns true, and
+// takes a life, if it hit one. Needs the collision grid like
+// game_checkLaserCollision.
+bool game_checkShipCollision();
+
 // Use this predicate to see if the game is finished.
 bool game_isGameOver();
 
+// Fold the game state into hash (see stateHash.h) and return the result.
+uint32_t game_hashState(uint32_t hash);
+
 #endif /* GAMECONTROL_H_ */
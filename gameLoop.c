@@ -0,0 +1,116 @@
+#include "gameLoop.h"
+#include "asteroid.h"
+#include "config.h"
+#include "framebuffer.h"
+#include "game.h"
+#include "input.h"
+#include "laser.h"
+#include "logger.h"
+#include "profiler.h"
+#include "profilerClock.h"
+#include "render.h"
+#include "scheduler.h"
+#include "spaceship.h"
+#include "stateHash.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// The log is drained as an idle job that must run within this many ticks of
+// a frame that left records behind. Each run formats a small batch.
+#define LOG_DRAIN_DEADLINE_TICKS 10
+#define LOG_DRAIN_COST_US 200
+
+static bool renderingEnabled = true;
+static uint8_t frameInTick; // Frames drawn since the last tick.
+
+#if CONFIG_PROFILER
+// Run one call and record how long it took under section.
+#define PROFILE(section, call)                                                 \
+  do {                                                                         \
+    uint32_t sectionStart = profilerClock_now();                               \
+    call;                                                                      \
+    profiler_record(section, profilerClock_now() - sectionStart);              \
+  } while (0)
+#else
+#define PROFILE(section, call) call
+#endif
+
+// Initialize every subsystem in the order the game needs.
+void gameLoop_init() {
+  profiler_init();
+  logger_init();
+  scheduler_init();
+  input_init();
+  framebuffer_init();
+  render_init();
+  asteroid_init();
+  laser_init();
+  spaceship_init();
+  game_init();
+  frameInTick = 0;
+}
+
+// Read this tick's input and run one tick of every subsystem.
+void gameLoop_tick() {
+#if CONFIG_PROFILER
+  uint32_t tickStart = profilerClock_now();
+#endif
+  scheduler_advanceTick();
+  logger_advanceTick();
+  PROFILE(profiler_input, input_tick());
+  PROFILE(profiler_asteroid, asteroid_tick());
+  PROFILE(profiler_laser, laser_tick());
+  PROFILE(profiler_spaceship, spaceship_tick());
+  PROFILE(profiler_game, game_tick());
+#if CONFIG_PROFILER
+  profiler_record(profiler_tick, profilerClock_now() - tickStart);
+#endif
+}
+
+// Submit every entity alpha of the way through its last move, then repaint
+// whatever changed and send it to the display in one go.
+static void gameLoop_draw(uint16_t alpha) {
+  asteroid_draw(alpha);
+  laser_draw(alpha);
+  spaceship_draw(alpha);
+  render_drawFrame();
+}
+
+// Tick when one is due, then draw this frame. Frame n after a tick is drawn
+// (n + 1) / CONFIG_FRAMES_PER_TICK of the way from the previous tick.
+void gameLoop_frame() {
+#if CONFIG_PROFILER
+  uint32_t frameStart = profilerClock_now();
+#endif
+  if (frameInTick == 0) {
+    gameLoop_tick();
+  }
+  frameInTick++;
+  if (renderingEnabled) {
+    uint16_t alpha = frameInTick * RENDER_ALPHA_ONE / CONFIG_FRAMES_PER_TICK;
+    PROFILE(profiler_render, gameLoop_draw(alpha));
+    PROFILE(profiler_present, framebuffer_present());
+  }
+  if (frameInTick == CONFIG_FRAMES_PER_TICK) {
+    frameInTick = 0;
+  }
+  if (!logger_isEmpty()) {
+    scheduler_post(logger_drain, LOG_DRAIN_DEADLINE_TICKS, LOG_DRAIN_COST_US);
+  }
+#if CONFIG_PROFILER
+  profiler_record(profiler_frame, profilerClock_now() - frameStart);
+#endif
+}
+
+// Turn drawing on or off.
+void gameLoop_setRendering(bool enabled) { renderingEnabled = enabled; }
+
+// Hash the state of every subsystem that carries state between ticks.
+uint32_t gameLoop_hashState() {
+  uint32_t hash = STATEHASH_INIT;
+  hash = input_hashState(hash);
+  hash = asteroid_hashState(hash);
+  hash = laser_hashState(hash);
+  hash = spaceship_hashState(hash);
+  return game_hashState(hash);
+}
@@ -0,0 +1,32 @@
+#ifndef GAMELOOP_H_
+#define GAMELOOP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Initialize every subsystem in the order the game needs. Shared by the board
+// and host programs so both run exactly the same ticks.
+void gameLoop_init();
+
+// Read this tick's input and advance every subsystem by one fixed tick of
+// CONFIG_TICK_PERIOD. Draws nothing; gameLoop_frame calls this when a tick
+// is due.
+void gameLoop_tick();
+
+// Run one timer period of CONFIG_TIMER_PERIOD: a tick on the first frame of
+// every CONFIG_FRAMES_PER_TICK, then draw and present this frame with
+// entities interpolated between their last two tick positions. The last
+// frame of each tick shows the tick's own positions, so with one frame per
+// tick this is the same as ticking and drawing.
+void gameLoop_frame();
+
+// Turn drawing on or off. With it off, frames still run every tick but
+// skip drawing and presenting, so headless runs spend their time on game
+// logic. On by default.
+void gameLoop_setRendering(bool enabled);
+
+// Hash of everything that decides what later ticks do. Two runs that give the
+// same hash after a tick will keep matching as long as their input matches.
+uint32_t gameLoop_hashState();
+
+#endif /* GAMELOOP_H_ */
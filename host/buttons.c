@@ -0,0 +1,8 @@
+#include "buttons.h"
+#include "hostInput.h"
+#include <stdint.h>
+
+int32_t buttons_init() { return BUTTONS_INIT_STATUS_OK; }
+
+// Return the current button state, one bit per button.
+uint8_t buttons_read() { return hostInput_getButtons(); }
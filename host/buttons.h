@@ -0,0 +1,20 @@
+#ifndef BUTTONS_H_
+#define BUTTONS_H_
+
+// Host stand-in for the ZYBO push button driver. Button state comes from the
+// scripted input source (hostInput.h).
+
+#include <stdint.h>
+
+#define BUTTONS_INIT_STATUS_OK 1
+#define BUTTONS_BTN0_MASK 0x1
+#define BUTTONS_BTN1_MASK 0x2
+#define BUTTONS_BTN2_MASK 0x4
+#define BUTTONS_BTN3_MASK 0x8
+
+int32_t buttons_init();
+
+// Return the current button state, one bit per button.
+uint8_t buttons_read();
+
+#endif /* BUTTONS_H_ */
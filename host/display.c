@@ -0,0 +1,266 @@
+#include "display.h"
+#include "font.h"
+#include "hostInput.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// The emulated panel. Every pixel written is counted so host runs can report
+// display traffic, and so is every write that left the pixel as it was.
+static uint16_t panel[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+static uint64_t pixelWrites;
+static uint64_t unchangedPixelWrites;
+
+static int16_t cursorX;
+static int16_t cursorY;
+static uint8_t textSize = 1;
+static uint16_t textColor = DISPLAY_WHITE;
+static uint16_t textBgColor = DISPLAY_WHITE; // Same as textColor: transparent.
+static bool textWrap = true;
+
+void display_init() {
+  display_fillScreen(DISPLAY_BLACK);
+  cursorX = 0;
+  cursorY = 0;
+  textSize = 1;
+  textColor = DISPLAY_WHITE;
+  textBgColor = DISPLAY_WHITE;
+  textWrap = true;
+}
+
+int16_t display_width() { return DISPLAY_WIDTH; }
+
+int16_t display_height() { return DISPLAY_HEIGHT; }
+
+void display_drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x >= 0 && x < DISPLAY_WIDTH && y >= 0 && y < DISPLAY_HEIGHT) {
+    unchangedPixelWrites += panel[y][x] == color;
+    panel[y][x] = color;
+    pixelWrites++;
+  }
+}
+
+void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color) {
+  int16_t x1 = x + w;
+  int16_t y1 = y + h;
+  x = x < 0 ? 0 : x;
+  y = y < 0 ? 0 : y;
+  x1 = x1 > DISPLAY_WIDTH ? DISPLAY_WIDTH : x1;
+  y1 = y1 > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : y1;
+  for (int16_t row = y; row < y1; row++) {
+    for (int16_t col = x; col < x1; col++) {
+      unchangedPixelWrites += panel[row][col] == color;
+      panel[row][col] = color;
+    }
+  }
+  if (x < x1 && y < y1) {
+    pixelWrites += (uint64_t)(x1 - x) * (y1 - y);
+  }
+}
+
+void display_fillScreen(uint16_t color) {
+  display_fillRect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, color);
+}
+
+void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  display_fillRect(x, y, 1, h, color);
+}
+
+void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  display_fillRect(x, y, w, 1, color);
+}
+
+void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color) {
+  display_drawFastHLine(x, y, w, color);
+  display_drawFastHLine(x, y + h - 1, w, color);
+  display_drawFastVLine(x, y, h, color);
+  display_drawFastVLine(x + w - 1, y, h, color);
+}
+
+// Bresenham's line, stepping along the longer axis.
+void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int16_t temp;
+  if (steep) {
+    temp = x0, x0 = y0, y0 = temp;
+    temp = x1, x1 = y1, y1 = temp;
+  }
+  if (x0 > x1) {
+    temp = x0, x0 = x1, x1 = temp;
+    temp = y0, y0 = y1, y1 = temp;
+  }
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) {
+      display_drawPixel(y0, x0, color);
+    } else {
+      display_drawPixel(x0, y0, color);
+    }
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+// Midpoint circle, plotting the eight symmetric points of each step.
+void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  display_drawPixel(x0, y0 + r, color);
+  display_drawPixel(x0, y0 - r, color);
+  display_drawPixel(x0 + r, y0, color);
+  display_drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    display_drawPixel(x0 + x, y0 + y, color);
+    display_drawPixel(x0 - x, y0 + y, color);
+    display_drawPixel(x0 + x, y0 - y, color);
+    display_drawPixel(x0 - x, y0 - y, color);
+    display_drawPixel(x0 + y, y0 + x, color);
+    display_drawPixel(x0 - y, y0 + x, color);
+    display_drawPixel(x0 + y, y0 - x, color);
+    display_drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+// Filled midpoint circle, drawn as vertical lines.
+void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  display_drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    display_drawFastVLine(x0 + x, y0 - y, 2 * y + 1, color);
+    display_drawFastVLine(x0 + y, y0 - x, 2 * x + 1, color);
+    display_drawFastVLine(x0 - x, y0 - y, 2 * y + 1, color);
+    display_drawFastVLine(x0 - y, y0 - x, 2 * x + 1, color);
+  }
+}
+
+// Draw one character cell. When bg equals color the background is left alone.
+void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                      uint16_t bg, uint8_t size) {
+  const uint8_t *glyph = font_getGlyph(c);
+  for (int16_t col = 0; col < DISPLAY_CHAR_WIDTH; col++) {
+    uint8_t line = (col < FONT_GLYPH_COLUMNS) ? glyph[col] : 0;
+    for (int16_t row = 0; row < DISPLAY_CHAR_HEIGHT; row++, line >>= 1) {
+      if (line & 0x1) {
+        display_fillRect(x + col * size, y + row * size, size, size, color);
+      } else if (bg != color) {
+        display_fillRect(x + col * size, y + row * size, size, size, bg);
+      }
+    }
+  }
+}
+
+void display_setCursor(int16_t x, int16_t y) {
+  cursorX = x;
+  cursorY = y;
+}
+
+void display_setTextColor(uint16_t c) {
+  textColor = c;
+  textBgColor = c;
+}
+
+void display_setTextColorBg(uint16_t c, uint16_t bg) {
+  textColor = c;
+  textBgColor = bg;
+}
+
+void display_setTextSize(uint8_t size) { textSize = (size > 0) ? size : 1; }
+
+void display_setTextWrap(bool wrap) { textWrap = wrap; }
+
+// Print at the cursor and advance it, wrapping at the right edge.
+void display_print(const char *str) {
+  for (; *str != '\0'; str++) {
+    if (*str == '\n') {
+      cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+      cursorX = 0;
+    } else if (*str != '\r') {
+      display_drawChar(cursorX, cursorY, *str, textColor, textBgColor,
+                       textSize);
+      cursorX += textSize * DISPLAY_CHAR_WIDTH;
+      if (textWrap && cursorX > DISPLAY_WIDTH - textSize * DISPLAY_CHAR_WIDTH) {
+        cursorY += textSize * DISPLAY_CHAR_HEIGHT;
+        cursorX = 0;
+      }
+    }
+  }
+}
+
+void display_println(const char *str) {
+  display_print(str);
+  display_print("\n");
+}
+
+bool display_isTouched() { return hostInput_isTouched(); }
+
+void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z) {
+  hostInput_getTouchPoint(x, y);
+  *z = hostInput_isTouched() ? 1 : 0;
+}
+
+void display_clearOldTouchData() {}
+
+uint16_t hostDisplay_getPixel(int16_t x, int16_t y) {
+  if (x >= 0 && x < DISPLAY_WIDTH && y >= 0 && y < DISPLAY_HEIGHT) {
+    return panel[y][x];
+  }
+  return DISPLAY_BLACK;
+}
+
+uint64_t hostDisplay_getPixelWrites() { return pixelWrites; }
+
+uint64_t hostDisplay_getUnchangedPixelWrites() { return unchangedPixelWrites; }
+
+// Save the panel as a binary PPM, expanding RGB565 to 8 bits per channel.
+bool hostDisplay_writePpm(const char *path) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+  for (int16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+    for (int16_t x = 0; x < DISPLAY_WIDTH; x++) {
+      uint16_t color = panel[y][x];
+      uint8_t rgb[3] = {(uint8_t)(((color >> 11) & 0x1F) * 255 / 31),
+                        (uint8_t)(((color >> 5) & 0x3F) * 255 / 63),
+                        (uint8_t)((color & 0x1F) * 255 / 31)};
+      fwrite(rgb, sizeof rgb, 1, file);
+    }
+  }
+  return fclose(file) == 0;
+}
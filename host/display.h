@@ -0,0 +1,67 @@
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+// Host stand-in for the ZYBO display driver. It keeps the same functions,
+// constants and font metrics, but draws into a memory buffer with a software
+// rasterizer and takes touches from the scripted input source (hostInput.h).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DISPLAY_WIDTH 320
+#define DISPLAY_HEIGHT 240
+
+// Size of one character cell at text size 1.
+#define DISPLAY_CHAR_WIDTH 6
+#define DISPLAY_CHAR_HEIGHT 8
+
+// RGB565 colors.
+#define DISPLAY_BLACK 0x0000
+#define DISPLAY_BLUE 0x001F
+#define DISPLAY_RED 0xF800
+#define DISPLAY_GREEN 0x07E0
+#define DISPLAY_CYAN 0x07FF
+#define DISPLAY_MAGENTA 0xF81F
+#define DISPLAY_YELLOW 0xFFE0
+#define DISPLAY_WHITE 0xFFFF
+
+void display_init();
+int16_t display_width();
+int16_t display_height();
+
+void display_fillScreen(uint16_t color);
+void display_drawPixel(int16_t x, int16_t y, uint16_t color);
+void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color);
+void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint16_t color);
+void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      uint16_t color);
+void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+
+void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                      uint16_t bg, uint8_t size);
+void display_setCursor(int16_t x, int16_t y);
+void display_setTextColor(uint16_t c);
+void display_setTextColorBg(uint16_t c, uint16_t bg);
+void display_setTextSize(uint8_t size);
+void display_setTextWrap(bool wrap);
+void display_print(const char *str);
+void display_println(const char *str);
+
+bool display_isTouched();
+void display_getTouchedPoint(int16_t *x, int16_t *y, uint8_t *z);
+void display_clearOldTouchData();
+
+// Host only: read back the emulated panel and its write counters, and save it
+// as a binary PPM image. Returns false if the file could not be written.
+// Unchanged writes are the ones that set a pixel to the color it already had.
+uint16_t hostDisplay_getPixel(int16_t x, int16_t y);
+uint64_t hostDisplay_getPixelWrites();
+uint64_t hostDisplay_getUnchangedPixelWrites();
+bool hostDisplay_writePpm(const char *path);
+
+#endif /* DISPLAY_H_ */
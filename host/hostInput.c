@@ -0,0 +1,118 @@
+#include "hostInput.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_LENGTH 128
+
+#define FIRE_BUTTON 0x8
+#define RIGHT_BUTTON 0x4
+#define THRUST_BUTTON 0x2
+
+typedef struct {
+  uint32_t tick;
+  uint8_t buttons;
+  bool touched;
+  int16_t touchX;
+  int16_t touchY;
+} inputEvent_t;
+
+// Touch the screen to start (and restart) a game, then keep turning and
+// firing with bursts of thrust. Repeats every DEMO_PERIOD ticks.
+#define DEMO_PERIOD 400
+static const inputEvent_t demoEvents[] = {
+    {.tick = 0, .buttons = 0, .touched = false},
+    {.tick = 5, .buttons = 0, .touched = true, .touchX = 160, .touchY = 120},
+    {.tick = 10, .buttons = 0, .touched = false},
+    {.tick = 20, .buttons = FIRE_BUTTON | RIGHT_BUTTON, .touched = false},
+    {.tick = 120, .buttons = FIRE_BUTTON | THRUST_BUTTON, .touched = false},
+    {.tick = 135, .buttons = FIRE_BUTTON | RIGHT_BUTTON, .touched = false},
+    {.tick = 250, .buttons = FIRE_BUTTON | THRUST_BUTTON, .touched = false},
+    {.tick = 260, .buttons = FIRE_BUTTON, .touched = false},
+    {.tick = 300, .buttons = FIRE_BUTTON | RIGHT_BUTTON, .touched = false},
+};
+
+static inputEvent_t events[HOSTINPUT_MAX_EVENTS];
+static uint16_t eventCount;
+static uint32_t repeatPeriod;
+static inputEvent_t current;
+static uint16_t nextEvent; // First event not yet applied.
+
+// Use the built-in demo script.
+void hostInput_useDemoScript() {
+  eventCount = sizeof demoEvents / sizeof demoEvents[0];
+  memcpy(events, demoEvents, sizeof demoEvents);
+  repeatPeriod = DEMO_PERIOD;
+  current = events[0];
+  nextEvent = 0;
+}
+
+// Load a script from a file. "repeat <period>" on a line of its own makes the
+// script start over every period ticks.
+bool hostInput_loadScript(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return false;
+  }
+  static inputEvent_t loaded[HOSTINPUT_MAX_EVENTS];
+  uint16_t loadedCount = 0;
+  uint32_t loadedPeriod = 0;
+  char line[LINE_LENGTH];
+  while (fgets(line, sizeof line, file) != NULL &&
+         loadedCount < HOSTINPUT_MAX_EVENTS) {
+    unsigned long tick;
+    long buttons;
+    int touched;
+    int x = 0, y = 0;
+    if (line[0] == '#') {
+      continue;
+    }
+    if (sscanf(line, " repeat %lu", &tick) == 1) {
+      loadedPeriod = tick;
+    } else if (sscanf(line, "%lu %li %d %d %d", &tick, &buttons,
+                      &touched, &x, &y) >= 3) {
+      loaded[loadedCount++] = (inputEvent_t){.tick = tick,
+                                             .buttons = (uint8_t)buttons,
+                                             .touched = touched != 0,
+                                             .touchX = x,
+                                             .touchY = y};
+    }
+  }
+  fclose(file);
+  if (loadedCount == 0) {
+    return false;
+  }
+  memcpy(events, loaded, loadedCount * sizeof(inputEvent_t));
+  eventCount = loadedCount;
+  repeatPeriod = loadedPeriod;
+  current = events[0];
+  nextEvent = 0;
+  return true;
+}
+
+// Move the input to the given tick: the last event at or before it wins.
+// Ticks normally only go forward, so carry on from the last event applied and
+// start over only when time goes backwards (as it does when a script repeats).
+void hostInput_setTick(uint32_t tick) {
+  if (repeatPeriod != 0) {
+    tick %= repeatPeriod;
+  }
+  if (nextEvent > 0 && events[nextEvent - 1].tick > tick) {
+    nextEvent = 0;
+    current = events[0];
+  }
+  while (nextEvent < eventCount && events[nextEvent].tick <= tick) {
+    current = events[nextEvent++];
+  }
+}
+
+uint8_t hostInput_getButtons() { return current.buttons; }
+
+bool hostInput_isTouched() { return current.touched; }
+
+void hostInput_getTouchPoint(int16_t *x, int16_t *y) {
+  *x = current.touchX;
+  *y = current.touchY;
+}
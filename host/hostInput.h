@@ -0,0 +1,30 @@
+#ifndef HOSTINPUT_H_
+#define HOSTINPUT_H_
+
+// Scripted input for host builds. A script is a text file of lines
+//   <tick> <button mask> <touched> [<touch x> <touch y>]
+// sorted by tick. From that tick on, buttons_read and display_isTouched
+// report the given values until the next line takes over. Blank lines and
+// lines starting with '#' are ignored. The button mask may be decimal or hex
+// (0x8 is the fire button).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HOSTINPUT_MAX_EVENTS 4096
+
+// Load a script. Returns false (and leaves the built-in demo script in place)
+// if the file cannot be read or has no valid lines.
+bool hostInput_loadScript(const char *path);
+
+// Use the built-in demo script: start a game, then fly, turn and fire.
+void hostInput_useDemoScript();
+
+// Move the input to the given tick. Call before running that tick.
+void hostInput_setTick(uint32_t tick);
+
+uint8_t hostInput_getButtons();
+bool hostInput_isTouched();
+void hostInput_getTouchPoint(int16_t *x, int16_t *y);
+
+#endif /* HOSTINPUT_H_ */
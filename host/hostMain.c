@@ -0,0 +1,276 @@
+// Runs the game on a Linux host against the software display backend, with
+// input from a script instead of the board's buttons and touch screen.
+//
+// usage: asteroidsHost [-t ticks] [-s script] [-o screenshot.ppm] [-r] [-n]
+//                      [-R record.log | -P replay.log] [-L log.bin]
+//                      [-j threads]
+//   -t  number of ticks to run (default DEFAULT_TICKS)
+//   -s  input script (see hostInput.h); the built-in demo is used otherwise
+//   -o  save the final screen as a PPM image
+//   -r  pace frames at CONFIG_TIMER_PERIOD like the board instead of running
+//       flat out
+//   -n  skip rendering: every subsystem still ticks but nothing is drawn,
+//       for soak tests and logic throughput numbers
+//   -R  record every tick's input and state hash to a session log
+//   -P  replay a session log instead of reading input; -t is ignored and the
+//       run stops at the end of the log, or with an error at the first tick
+//       whose state hash differs from the recording
+//   -L  write log records in binary to a file instead of printing them, for
+//       asteroidsLogDecode
+//   -j  threads for the per-entity phases of a tick (see parallel.h); the
+//       default is one per online CPU. Results are the same for any count.
+//
+// Every tick is CONFIG_FRAMES_PER_TICK frames. Without -r, frames run back to
+// back with no timer. The run ends with a report
+// of wall time and ticks per second. With CONFIG_FRAMEBUFFER_DOUBLE_BUFFER the
+// run fails if the display was sent any pixel it already showed.
+
+#define _POSIX_C_SOURCE 200809L
+#include "asteroid.h"
+#include "config.h"
+#include "display.h"
+#include "framebuffer.h"
+#include "game.h"
+#include "gameLoop.h"
+#include "hostInput.h"
+#include "input.h"
+#include "inputLog.h"
+#include "logger.h"
+#include "parallel.h"
+#include "profiler.h"
+#include "render.h"
+#include "scheduler.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_TICKS 3000
+#define NS_PER_SECOND 1000000000ULL
+#define PERIOD_NS ((uint64_t)(CONFIG_TIMER_PERIOD * NS_PER_SECOND))
+#define USAGE                                                                  \
+  "usage: %s [-t ticks] [-s script] [-o screenshot.ppm] [-r] [-n] "            \
+  "[-R record.log | -P replay.log] [-L log.bin] [-j threads]\n"
+
+static uint64_t nextFrameNs; // When the next frame is due, in real time.
+
+static uint64_t nowNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * NS_PER_SECOND + (uint64_t)now.tv_nsec;
+}
+
+// Run idle jobs in the slack after a frame. In real time the slack is what is
+// left of the period, followed by a blocking sleep until the next frame is
+// due. Flat out, jobs get a whole period's budget, as if the frame had taken
+// no time. Budgets are in profilerClock ticks, which are nanoseconds here.
+static void idle(bool realTime) {
+  if (!realTime) {
+    scheduler_runIdle(PERIOD_NS);
+    return;
+  }
+  nextFrameNs += PERIOD_NS;
+  uint64_t now = nowNs();
+  scheduler_runIdle(now < nextFrameNs ? (uint32_t)(nextFrameNs - now) : 0);
+  struct timespec deadline = {.tv_sec = nextFrameNs / NS_PER_SECOND,
+                              .tv_nsec = nextFrameNs % NS_PER_SECOND};
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+// Run one tick's frames the way the board would, logging the tick when
+// recording. The tick itself runs in the first frame.
+static bool runTick(uint32_t tick, FILE *recordFile, bool realTime) {
+  hostInput_setTick(tick);
+  for (uint8_t frame = 0; frame < CONFIG_FRAMES_PER_TICK; frame++) {
+    gameLoop_frame();
+    idle(realTime);
+  }
+  return recordFile == NULL ||
+         inputLog_writeTick(recordFile, input_getFrame(), gameLoop_hashState());
+}
+
+// Feed a session log back through the game, checking the state hash after
+// every tick. Returns the number of ticks replayed, or -1 on an error.
+static int64_t replay(FILE *replayFile, bool realTime) {
+  if (!inputLog_readHeader(replayFile)) {
+    fprintf(stderr, "not a session log\n");
+    return -1;
+  }
+  uint32_t tick = 0;
+  input_frame_t frame;
+  uint32_t recordedHash;
+  inputLog_status_t status;
+  while ((status = inputLog_readTick(replayFile, &frame, &recordedHash)) ==
+         inputLog_ok) {
+    input_replay(frame);
+    runTick(tick, NULL, realTime);
+    uint32_t hash = gameLoop_hashState();
+    if (hash != recordedHash) {
+      fprintf(stderr,
+              "replay diverged at tick %lu: state hash %08lx, recorded "
+              "%08lx\n",
+              (unsigned long)tick, (unsigned long)hash,
+              (unsigned long)recordedHash);
+      return -1;
+    }
+    tick++;
+  }
+  if (status == inputLog_error) {
+    fprintf(stderr, "session log is truncated after tick %lu\n",
+            (unsigned long)tick);
+    return -1;
+  }
+  return tick;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t ticks = DEFAULT_TICKS;
+  const char *scriptPath = NULL;
+  const char *screenshotPath = NULL;
+  const char *recordPath = NULL;
+  const char *replayPath = NULL;
+  const char *logPath = NULL;
+  bool realTime = false;
+  bool rendering = true;
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int option;
+  while ((option = getopt(argc, argv, "t:s:o:rnR:P:L:j:")) != -1) {
+    switch (option) {
+    case 't':
+      ticks = strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      scriptPath = optarg;
+      break;
+    case 'o':
+      screenshotPath = optarg;
+      break;
+    case 'r':
+      realTime = true;
+      break;
+    case 'n':
+      rendering = false;
+      break;
+    case 'R':
+      recordPath = optarg;
+      break;
+    case 'P':
+      replayPath = optarg;
+      break;
+    case 'L':
+      logPath = optarg;
+      break;
+    case 'j':
+      threads = strtol(optarg, NULL, 0);
+      break;
+    default:
+      fprintf(stderr, USAGE, argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (recordPath != NULL && replayPath != NULL) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  hostInput_useDemoScript();
+  if (scriptPath != NULL && !hostInput_loadScript(scriptPath)) {
+    fprintf(stderr, "could not load input script %s\n", scriptPath);
+    return EXIT_FAILURE;
+  }
+
+  FILE *recordFile = NULL;
+  FILE *replayFile = NULL;
+  if (recordPath != NULL &&
+      ((recordFile = fopen(recordPath, "wb")) == NULL ||
+       !inputLog_writeHeader(recordFile))) {
+    fprintf(stderr, "could not write %s\n", recordPath);
+    return EXIT_FAILURE;
+  }
+  if (replayPath != NULL && (replayFile = fopen(replayPath, "rb")) == NULL) {
+    fprintf(stderr, "could not read %s\n", replayPath);
+    return EXIT_FAILURE;
+  }
+
+  parallel_init(threads < 1 ? 1 : threads > UINT8_MAX ? UINT8_MAX : threads);
+  display_init();
+  gameLoop_init();
+  // Clearing the panel at init rewrites black with black; only count the
+  // game's own writes.
+  uint64_t initUnchangedWrites = hostDisplay_getUnchangedPixelWrites();
+  FILE *logFile = NULL;
+  if (logPath != NULL && ((logFile = fopen(logPath, "wb")) == NULL ||
+                          !logger_setBinaryOutput(logFile))) {
+    fprintf(stderr, "could not write %s\n", logPath);
+    return EXIT_FAILURE;
+  }
+  gameLoop_setRendering(rendering);
+  game_enable();
+  uint64_t start = nowNs();
+  nextFrameNs = start;
+  if (replayFile != NULL) {
+    int64_t replayed = replay(replayFile, realTime);
+    fclose(replayFile);
+    if (replayed < 0) {
+      return EXIT_FAILURE;
+    }
+    ticks = (uint32_t)replayed;
+    printf("replay matched the recording\n");
+  } else {
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+      if (!runTick(tick, recordFile, realTime)) {
+        fprintf(stderr, "could not write %s\n", recordPath);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  uint64_t elapsed = nowNs() - start;
+  // Whatever the idle jobs did not get to.
+  while (!logger_isEmpty()) {
+    logger_drain();
+  }
+  if (logFile != NULL && fclose(logFile) != 0) {
+    fprintf(stderr, "could not write %s\n", logPath);
+    return EXIT_FAILURE;
+  }
+  if (recordFile != NULL && fclose(recordFile) != 0) {
+    fprintf(stderr, "could not write %s\n", recordPath);
+    return EXIT_FAILURE;
+  }
+
+  render_stats_t renderStats = render_getStats();
+  framebuffer_stats_t framebufferStats = framebuffer_getStats();
+  double seconds = (double)elapsed / NS_PER_SECOND;
+  printf("ticks: %lu (%.1f s of game time)\n", (unsigned long)ticks,
+         ticks * CONFIG_TICK_PERIOD);
+  printf("wall time: %.3f s\n", seconds);
+  printf("ticks/s: %.0f\n", seconds > 0 ? ticks / seconds : 0);
+  printf("threads: %u\n", parallel_getThreadCount());
+  printf("asteroid high-water mark: %u\n", asteroid_getHighWaterMark());
+  printf("framebuffer pixel writes: %llu (erase/redraw would be %llu)\n",
+         (unsigned long long)renderStats.totalPixels,
+         (unsigned long long)renderStats.totalLegacyPixels);
+  uint64_t unchangedWrites =
+      hostDisplay_getUnchangedPixelWrites() - initUnchangedWrites;
+  printf("display pixel writes: %llu in %llu runs, %llu unchanged\n",
+         (unsigned long long)hostDisplay_getPixelWrites(),
+         (unsigned long long)framebufferStats.totalRuns,
+         (unsigned long long)unchangedWrites);
+  printf("log records dropped: %lu\n",
+         (unsigned long)logger_getDroppedCount());
+  profiler_dump();
+  if (screenshotPath != NULL && !hostDisplay_writePpm(screenshotPath)) {
+    fprintf(stderr, "could not write %s\n", screenshotPath);
+    return EXIT_FAILURE;
+  }
+  // With a copy of the panel to compare against, present must never send a
+  // pixel the panel already shows.
+  if (CONFIG_FRAMEBUFFER_DOUBLE_BUFFER && unchangedWrites != 0) {
+    fprintf(stderr, "present sent %llu pixels the display already showed\n",
+            (unsigned long long)unchangedWrites);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
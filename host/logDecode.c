@@ -0,0 +1,35 @@
+// Prints a binary log written by asteroidsHost -L as text, one record per
+// line, in the same format logger_drain prints on the board.
+//
+// usage: asteroidsLogDecode log.bin
+
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEXT_SIZE 128
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s log.bin\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  FILE *file = fopen(argv[1], "rb");
+  if (file == NULL) {
+    fprintf(stderr, "could not read %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  if (!logger_readHeader(file)) {
+    fprintf(stderr, "%s is not a binary log\n", argv[1]);
+    fclose(file);
+    return EXIT_FAILURE;
+  }
+  logger_record_t record;
+  char text[TEXT_SIZE];
+  while (logger_readRecord(file, &record)) {
+    logger_format(&record, text, sizeof text);
+    puts(text);
+  }
+  fclose(file);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#define _POSIX_C_SOURCE 200809L
+#include "parallel.h"
+#include "config.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Each loop is cut into about this many chunks per thread, so a thread that
+// gets slow chunks does not hold up the others.
+#define CHUNKS_PER_THREAD 4
+
+static uint8_t threadCount = 1;
+static pthread_t workers[CONFIG_PARALLEL_MAX_WORKERS];
+static _Thread_local uint8_t workerIndex;
+
+// The loop in progress. Workers sleep on workReady until generation moves
+// on, take chunks from nextChunk until there are none left, and the last one
+// to finish signals workDone.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t workDone = PTHREAD_COND_INITIALIZER;
+static uint32_t generation;
+static uint8_t busyWorkers;
+static parallel_job_t loopJob;
+static void *loopContext;
+static uint16_t loopCount;
+static uint16_t loopChunkSize;
+static atomic_uint nextChunk;
+
+// Run chunks of the current loop until none are left.
+static void parallel_runChunks() {
+  uint32_t chunkCount = (loopCount + loopChunkSize - 1) / loopChunkSize;
+  uint32_t chunk;
+  while ((chunk = atomic_fetch_add(&nextChunk, 1)) < chunkCount) {
+    uint32_t begin = chunk * loopChunkSize;
+    uint32_t end = begin + loopChunkSize;
+    loopJob(begin, end < loopCount ? end : loopCount, loopContext);
+  }
+}
+
+static void *parallel_worker(void *index) {
+  workerIndex = (uint8_t)(uintptr_t)index;
+  uint32_t seen = 0;
+  pthread_mutex_lock(&lock);
+  while (true) {
+    while (generation == seen) {
+      pthread_cond_wait(&workReady, &lock);
+    }
+    seen = generation;
+    pthread_mutex_unlock(&lock);
+    parallel_runChunks();
+    pthread_mutex_lock(&lock);
+    if (--busyWorkers == 0) {
+      pthread_cond_signal(&workDone);
+    }
+  }
+  return NULL;
+}
+
+// Start the worker threads. A thread that cannot be started leaves the pool
+// smaller.
+void parallel_init(uint8_t count) {
+  count = count < 1 ? 1 : count;
+  count = count > CONFIG_PARALLEL_MAX_WORKERS ? CONFIG_PARALLEL_MAX_WORKERS
+                                              : count;
+  for (threadCount = 1; threadCount < count; threadCount++) {
+    if (pthread_create(&workers[threadCount], NULL, parallel_worker,
+                       (void *)(uintptr_t)threadCount) != 0) {
+      break;
+    }
+  }
+}
+
+uint8_t parallel_getThreadCount() { return threadCount; }
+
+// Hand the loop to the workers and take chunks alongside them. The mutex
+// hand-offs order each worker's writes before the return.
+void parallel_for(uint16_t count, uint16_t grain, parallel_job_t job,
+                  void *context) {
+  grain = grain < 1 ? 1 : grain;
+  if (threadCount == 1 || count < 2 * (uint32_t)grain) {
+    if (count > 0) {
+      job(0, count, context);
+    }
+    return;
+  }
+  uint32_t chunkCount = threadCount * CHUNKS_PER_THREAD;
+  uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+  pthread_mutex_lock(&lock);
+  loopJob = job;
+  loopContext = context;
+  loopCount = count;
+  loopChunkSize = chunkSize < grain ? grain : chunkSize;
+  atomic_store(&nextChunk, 0);
+  busyWorkers = threadCount - 1;
+  generation++;
+  pthread_cond_broadcast(&workReady);
+  pthread_mutex_unlock(&lock);
+
+  parallel_runChunks();
+
+  pthread_mutex_lock(&lock);
+  while (busyWorkers > 0) {
+    pthread_cond_wait(&workDone, &lock);
+  }
+  pthread_mutex_unlock(&lock);
+}
+
+uint8_t parallel_getWorker() { return workerIndex; }
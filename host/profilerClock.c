@@ -0,0 +1,15 @@
+#define _POSIX_C_SOURCE 199309L
+#include "profilerClock.h"
+#include <stdint.h>
+#include <time.h>
+
+#define NS_PER_SECOND 1000000000UL
+
+// Nanoseconds from CLOCK_MONOTONIC, truncated to 32 bits.
+uint32_t profilerClock_now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * NS_PER_SECOND + now.tv_nsec);
+}
+
+uint32_t profilerClock_ticksPerSecond() { return NS_PER_SECOND; }
@@ -0,0 +1,18 @@
+#define _POSIX_C_SOURCE 199309L
+#include "utils.h"
+#include <stdint.h>
+#include <time.h>
+
+#define MS_PER_SECOND 1000
+#define NS_PER_MS 1000000
+
+// Block for the given number of milliseconds.
+void utils_msDelay(uint32_t msDelay) {
+  struct timespec delay = {.tv_sec = msDelay / MS_PER_SECOND,
+                           .tv_nsec = (long)(msDelay % MS_PER_SECOND) *
+                                      NS_PER_MS};
+  nanosleep(&delay, NULL);
+}
+
+// Nothing to wait for on the host; returns immediately.
+void utils_sleep() {}
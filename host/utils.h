@@ -0,0 +1,14 @@
+#ifndef UTILS_H_
+#define UTILS_H_
+
+// Host stand-in for the ZYBO utility routines.
+
+#include <stdint.h>
+
+// Block for the given number of milliseconds.
+void utils_msDelay(uint32_t msDelay);
+
+// Nothing to wait for on the host; returns immediately.
+void utils_sleep();
+
+#endif /* UTILS_H_ */
@@ -0,0 +1,89 @@
+#include "input.h"
+#include "buttons.h"
+#include "display.h"
+#include "stateHash.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BUTTONS_MASK 0x0F // BTN0-BTN3.
+#define INPUT_BIT_COUNT 5 // BTN0-BTN3 and INPUT_TOUCH.
+
+static input_frame_t currentFrame;
+static input_frame_t replayFrame;
+static bool replayPending;
+
+// Debounced state. pendingTicks counts, for each bit, the ticks in a row the
+// raw reading has disagreed with held.
+static uint8_t held;
+static uint8_t pressed;
+static uint8_t released;
+static uint8_t pendingTicks[INPUT_BIT_COUNT];
+static const uint8_t debounceTicks[INPUT_BIT_COUNT] = {
+    INPUT_BUTTON_DEBOUNCE_TICKS, INPUT_BUTTON_DEBOUNCE_TICKS,
+    INPUT_BUTTON_DEBOUNCE_TICKS, INPUT_BUTTON_DEBOUNCE_TICKS,
+    INPUT_TOUCH_DEBOUNCE_TICKS};
+
+// Clear the current frame, the debounced state and any pending replayed
+// frame.
+void input_init() {
+  currentFrame = (input_frame_t){.buttons = 0, .touched = false};
+  replayPending = false;
+  held = 0;
+  pressed = 0;
+  released = 0;
+  memset(pendingTicks, 0, sizeof pendingTicks);
+}
+
+// Flip a held bit once the raw reading has disagreed with it for more than
+// its debounce time, then work out this tick's edges.
+static void input_debounce(uint8_t raw) {
+  uint8_t previous = held;
+  for (uint8_t bit = 0; bit < INPUT_BIT_COUNT; bit++) {
+    uint8_t mask = 1 << bit;
+    if (!((raw ^ held) & mask)) {
+      pendingTicks[bit] = 0;
+    } else if (pendingTicks[bit] >= debounceTicks[bit]) {
+      held ^= mask;
+      pendingTicks[bit] = 0;
+    } else {
+      pendingTicks[bit]++;
+    }
+  }
+  pressed = held & ~previous;
+  released = previous & ~held;
+}
+
+// Read the buttons and touch screen once for this tick, or take the replayed
+// frame if there is one.
+void input_tick() {
+  if (replayPending) {
+    currentFrame = replayFrame;
+    replayPending = false;
+  } else {
+    currentFrame.buttons = buttons_read() & BUTTONS_MASK;
+    currentFrame.touched = display_isTouched();
+  }
+  input_debounce(currentFrame.buttons |
+                 (currentFrame.touched ? INPUT_TOUCH : 0));
+}
+
+// Use this frame for the next input_tick instead of reading the hardware.
+void input_replay(input_frame_t frame) {
+  replayFrame = frame;
+  replayPending = true;
+}
+
+input_frame_t input_getFrame() { return currentFrame; }
+
+uint8_t input_getHeld() { return held; }
+
+uint8_t input_getPressed() { return pressed; }
+
+uint8_t input_getReleased() { return released; }
+
+// Fold the debounce state into hash. The edges follow from it.
+uint32_t input_hashState(uint32_t hash) {
+  hash = stateHash_add(hash, &held, sizeof held);
+  return stateHash_add(hash, pendingTicks, sizeof pendingTicks);
+}
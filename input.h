@@ -0,0 +1,58 @@
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bits of the masks returned by input_getHeld, input_getPressed and
+// input_getReleased. The button bits are the ones buttons_read returns.
+#define INPUT_BTN0 0x01
+#define INPUT_BTN1 0x02
+#define INPUT_BTN2 0x04
+#define INPUT_BTN3 0x08
+#define INPUT_TOUCH 0x10
+
+// Ticks a change has to last after the tick it first shows up in before it
+// is believed. Buttons are only sampled once per tick, which is already
+// longer than contact bounce. The touch controller's ADC needs a tick to
+// settle after the panel is first touched.
+#ifndef INPUT_BUTTON_DEBOUNCE_TICKS
+#define INPUT_BUTTON_DEBOUNCE_TICKS 0
+#endif
+#ifndef INPUT_TOUCH_DEBOUNCE_TICKS
+#define INPUT_TOUCH_DEBOUNCE_TICKS 1
+#endif
+
+// Everything read from the hardware in one tick, before debouncing. This is
+// what session logs record.
+typedef struct {
+  uint8_t buttons; // BTN0-BTN3 as returned by buttons_read.
+  bool touched;
+} input_frame_t;
+
+// Clear the current frame, the debounced state and any pending replayed
+// frame.
+void input_init();
+
+// Read the buttons and touch screen once for this tick and debounce them. If
+// a frame was handed to input_replay since the last call, use it instead of
+// the hardware. Call at the start of every tick, before any subsystem looks
+// at input; every subsystem then sees the same snapshot.
+void input_tick();
+
+// Use this frame for the next input_tick instead of reading the hardware.
+void input_replay(input_frame_t frame);
+
+// The raw frame read by the last input_tick.
+input_frame_t input_getFrame();
+
+// Debounced input as INPUT_* masks: what is down this tick, what went down
+// this tick and what came up this tick.
+uint8_t input_getHeld();
+uint8_t input_getPressed();
+uint8_t input_getReleased();
+
+// Fold the debounce state into hash (see stateHash.h) and return the result.
+uint32_t input_hashState(uint32_t hash);
+
+#endif /* INPUT_H_ */
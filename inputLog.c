@@ -0,0 +1,59 @@
+#include "inputLog.h"
+#include "input.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define HEADER_SIZE 4
+#define RECORD_SIZE 5
+#define BUTTONS_BITS 0x0F
+#define TOUCHED_BIT 0x10
+
+static const uint8_t header[HEADER_SIZE] = {'A', 'I', 'L', INPUTLOG_VERSION};
+
+// Write the header. Returns false on a write error.
+bool inputLog_writeHeader(FILE *file) {
+  return fwrite(header, sizeof header, 1, file) == 1;
+}
+
+// Append one tick. Returns false on a write error.
+bool inputLog_writeTick(FILE *file, input_frame_t frame, uint32_t stateHash) {
+  uint8_t record[RECORD_SIZE] = {
+      (uint8_t)((frame.buttons & BUTTONS_BITS) |
+                (frame.touched ? TOUCHED_BIT : 0)),
+      (uint8_t)stateHash, (uint8_t)(stateHash >> 8),
+      (uint8_t)(stateHash >> 16), (uint8_t)(stateHash >> 24)};
+  return fwrite(record, sizeof record, 1, file) == 1;
+}
+
+// Check the header. Returns false if this is not a log this code can read.
+bool inputLog_readHeader(FILE *file) {
+  uint8_t read[HEADER_SIZE];
+  if (fread(read, sizeof read, 1, file) != 1) {
+    return false;
+  }
+  for (uint8_t i = 0; i < HEADER_SIZE; i++) {
+    if (read[i] != header[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Read the next tick.
+inputLog_status_t inputLog_readTick(FILE *file, input_frame_t *frame,
+                                    uint32_t *stateHash) {
+  uint8_t record[RECORD_SIZE];
+  size_t count = fread(record, 1, sizeof record, file);
+  if (count == 0 && feof(file)) {
+    return inputLog_end;
+  }
+  if (count != sizeof record) {
+    return inputLog_error;
+  }
+  frame->buttons = record[0] & BUTTONS_BITS;
+  frame->touched = (record[0] & TOUCHED_BIT) != 0;
+  *stateHash = (uint32_t)record[1] | ((uint32_t)record[2] << 8) |
+               ((uint32_t)record[3] << 16) | ((uint32_t)record[4] << 24);
+  return inputLog_ok;
+}
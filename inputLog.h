@@ -0,0 +1,39 @@
+#ifndef INPUTLOG_H_
+#define INPUTLOG_H_
+
+#include "input.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// A session log: a short header, then one record per tick, written as the
+// game runs so nothing needs to be buffered. Each record is the tick's input
+// frame and the hash of the game state after the tick (gameLoop_hashState).
+// Feeding the frames back through input_replay reproduces the session, and
+// the hashes show the first tick where a replay stops matching.
+//
+// Header: the bytes 'A' 'I' 'L' then INPUTLOG_VERSION.
+// Record: one byte with the buttons in bits 0-3 and touched in bit 4, then
+// the 32-bit hash, little endian. 5 bytes per tick.
+#define INPUTLOG_VERSION 1
+
+typedef enum {
+  inputLog_ok,    // A record was read.
+  inputLog_end,   // The log ended cleanly before this record.
+  inputLog_error, // The file could not be read or the record was cut short.
+} inputLog_status_t;
+
+// Write the header. Returns false on a write error.
+bool inputLog_writeHeader(FILE *file);
+
+// Append one tick. Returns false on a write error.
+bool inputLog_writeTick(FILE *file, input_frame_t frame, uint32_t stateHash);
+
+// Check the header. Returns false if this is not a log this code can read.
+bool inputLog_readHeader(FILE *file);
+
+// Read the next tick.
+inputLog_status_t inputLog_readTick(FILE *file, input_frame_t *frame,
+                                    uint32_t *stateHash);
+
+#endif /* INPUTLOG_H_ */
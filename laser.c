@@ -1,161 +1,86 @@
-#ifndef LASER_H_
-#define LASER_H_
-
 #include "laser.h"
 #include "display.h"
-#include "time.h"
+#include "entity.h"
+#include "logger.h"
+#include "render.h"
+#include "stateHash.h"
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
-
-#define INIT_ST_MSG "laser_init_st\n"
-#define PLAY_ST_MSG "laser_play_st\n"
-#define ERROR_ST_MSG "laser_error_st\n"
 
-#define LASER_LIFE_COUNTER_MAX 20
-#define MAX_LASER_COUNT 5
+// How long a laser flies before it disappears, in seconds, and the same time
+// in ticks.
+#define LASER_LIFETIME 2.0
+#define LASER_LIFE_COUNTER_MAX                                                 \
+  ((uint8_t)(LASER_LIFETIME / CONFIG_TICK_PERIOD + 0.5))
 #define LASER_RADIUS 2
 #define DISPLAY_MID_X DISPLAY_WIDTH / 2
 #define DISPLAY_MID_Y DISPLAY_HEIGHT / 2
 
-static struct Laser *headLaser;
-static struct Laser *tailLaser;
-static uint8_t laserCount;
 static bool enabled;
-
-struct Laser {
-  int16_t x;
-  int16_t y;
-  int8_t xVelocity;
-  int8_t yVelocity;
-  uint8_t radius;
-  bool collision;
-  struct Laser *previousLaser;
-  struct Laser *nextLaser;
-  uint8_t lifeCounter;
-};
+// Every laser in flight, in the order they were fired (see entity.h). A
+// laser's age is its life counter.
+ENTITY_STORE(lasers, MAX_LASER_COUNT);
 
 static enum laserControl_st_t { init_st, play_st } currentState, nextState;
 
 // it adds an laser. What's there to explain?
-struct Laser *laser_addLaser(int16_t myX, int16_t myY, int8_t myXVelocity,
-                             int8_t myYVelocity) {
-  struct Laser *newLaser = (struct Laser *)malloc(sizeof(struct Laser));
-  if (newLaser) {
-    newLaser->x = myX;
-    newLaser->y = myY;
-    newLaser->xVelocity = myXVelocity;
-    newLaser->yVelocity = myYVelocity;
-    newLaser->radius = LASER_RADIUS;
-    newLaser->collision = false;
-    newLaser->nextLaser = NULL;
-    newLaser->lifeCounter = 0;
-  }
-  if (laserCount) {
-    tailLaser->nextLaser = newLaser;
-    newLaser->previousLaser = tailLaser;
-    tailLaser = newLaser;
-  } else {
-    headLaser = newLaser;
-    tailLaser = newLaser;
-    newLaser->previousLaser = NULL;
-  }
-  ++laserCount;
-  return newLaser;
-}
-
-void laser_drawLaser(struct Laser *laser) {
-  display_fillCircle(laser->x, laser->y, laser->radius, DISPLAY_WHITE);
+bool laser_addLaser(int16_t myX, int16_t myY, int8_t myXVelocity,
+                    int8_t myYVelocity) {
+  return entity_create(&lasers, myX, myY, myXVelocity, myYVelocity,
+                       LASER_RADIUS) != ENTITY_HANDLE_NONE;
 }
 
-void laser_eraseLaser(struct Laser *laser) {
-  display_fillCircle(laser->x, laser->y, laser->radius, DISPLAY_BLACK);
-}
-
-void laser_destroyLaser(struct Laser *laser) {
-  if (laser != NULL && laserCount > 0) {
-    laser_eraseLaser(laser);
-    struct Laser *previous = laser->previousLaser;
-    struct Laser *next = laser->nextLaser;
-    if (next != NULL) {
-      next->previousLaser = previous;
-    }
-    if (previous != NULL) {
-      previous->nextLaser = next;
-    }
-    if (laser == headLaser) {
-      headLaser = next;
-    }
-    if (laser == tailLaser) {
-      tailLaser = previous;
-    }
-    free(laser);
-    --laserCount;
-  }
+// Submit the laser to this frame's render list, alpha of the way through its
+// last move. Lasers that stop being drawn are erased by the render stage.
+void laser_drawLaser(uint16_t index, uint16_t alpha) {
+  render_fillCircle(
+      render_lerp(lasers.previousX[index], lasers.x[index], alpha),
+      render_lerp(lasers.previousY[index], lasers.y[index], alpha),
+      lasers.radius[index]);
 }
 
-void laser_eraseAll() {
-  if (laserCount != 0) {
-    struct Laser *laser = headLaser;
-    while (laser != NULL) {
-      struct Laser *temp = laser->nextLaser;
-      laser_eraseLaser(laser);
-      laser_destroyLaser(laser);
-      laser = temp;
-      --laserCount;
-    }
-  }
-}
+void laser_eraseAll() { entity_clear(&lasers); }
 
 void laser_enable() {
   enabled = true;
-  printf("we got this far\n");
+  LOG_DEBUG(logger_laserEnabled, 0, 0);
 }
 
 void laser_disable() {
   laser_eraseAll();
   enabled = false;
-  printf("now we're this far\n");
+  LOG_DEBUG(logger_laserDisabled, 0, 0);
 }
 
-void laser_collision(struct Laser *laser) {
-  laser->collision = true;
-  laser_eraseLaser(laser);
-}
-
-void laser_moveLaser(struct Laser *laser) {
-  if (laser->x <= (-1 * laser->radius)) {
-    laser->x = DISPLAY_WIDTH;
-  } else if (laser->x >= (DISPLAY_WIDTH + laser->radius)) {
-    laser->x = 0;
-  } else {
-    laser->x = laser->x + laser->xVelocity;
-  }
-  if (laser->y <= (-1 * laser->radius)) {
-    laser->y = DISPLAY_HEIGHT;
-  } else if (laser->y >= (DISPLAY_HEIGHT + laser->radius)) {
-    laser->y = 0;
-  } else {
-    laser->y = laser->y + laser->yVelocity;
+// A laser that hit something is no longer drawn. Stopping it keeps the move
+// kernel from carrying it on.
+void laser_collision(entity_handle_t laser) {
+  uint16_t index = entity_getIndex(&lasers, laser);
+  if (index != ENTITY_NONE) {
+    lasers.flags[index] |= ENTITY_FLAG_COLLISION;
+    lasers.xVelocity[index] = 0;
+    lasers.yVelocity[index] = 0;
   }
 }
 
 // starts laser state machine, it doesn't really have that much to do
 void laser_init() {
-  laserCount = 0;
+  entity_init(&lasers);
+  currentState = init_st;
+  nextState = init_st;
   enabled = false;
 }
 
 void laser_debugState() {
   switch (currentState) {
   case init_st:
-    printf(INIT_ST_MSG);
+    LOG_DEBUG(logger_laserInitState, 0, 0);
     break;
   case play_st:
-    printf(PLAY_ST_MSG);
+    LOG_DEBUG(logger_laserPlayState, 0, 0);
     break;
   default:
-    printf(ERROR_ST_MSG);
+    LOG_ERROR(logger_errorState, currentState, 0);
     break;
   }
 }
@@ -169,7 +94,7 @@ void laser_tick() {
   switch (currentState) {
   case init_st:
     if (!enabled) {
-      laserCount = 0;
+      laser_eraseAll();
       nextState = init_st;
     } else {
       nextState = play_st;
@@ -180,20 +105,12 @@ void laser_tick() {
       laser_eraseAll();
       nextState = init_st;
     } else {
-      struct Laser *laser = headLaser;
-      while (laser != NULL && headLaser != NULL) {
-        if (laser->lifeCounter >= LASER_LIFE_COUNTER_MAX) {
-          laser_destroyLaser(laser);
-        } else if (laser->collision) {
-          laser_collision(laser);
-        } else {
-          laser_eraseLaser(laser);
-          laser_moveLaser(laser);
-          laser_drawLaser(laser);
-        }
-        laser->lifeCounter = laser->lifeCounter + 1;
-        laser = laser->nextLaser;
-      }
+      // Retire the expired lasers in one pass. The flush keeps the rest in
+      // firing order.
+      entity_killAged(&lasers, LASER_LIFE_COUNTER_MAX);
+      entity_flush(&lasers);
+      entity_moveAll(&lasers);
+      entity_ageAll(&lasers);
       nextState = play_st;
     }
     break;
@@ -205,13 +122,26 @@ void laser_tick() {
   // means nothing in the end
 }
 
-uint8_t laser_getCount() { return laserCount; }
+// Submit every laser that has not hit anything.
+void laser_draw(uint16_t alpha) {
+  for (uint16_t i = 0; i < lasers.count; i++) {
+    if (!(lasers.flags[i] & ENTITY_FLAG_COLLISION)) {
+      laser_drawLaser(i, alpha);
+    }
+  }
+}
+
+uint16_t laser_getCount() { return lasers.count; }
 
-struct Laser *laser_getHeadLaser() {
-  return headLaser;
+entity_handle_t laser_getHandle(uint16_t index) {
+  return entity_getHandle(&lasers, index);
 }
 
-struct Laser *laser_getTailLaser() {
-  return tailLaser;
+entity_view_t laser_getView() { return entity_getView(&lasers); }
+
+// Fold the laser state into hash, oldest laser first.
+uint32_t laser_hashState(uint32_t hash) {
+  hash = stateHash_add(hash, &currentState, sizeof currentState);
+  hash = stateHash_add(hash, &enabled, sizeof enabled);
+  return entity_hashState(&lasers, hash);
 }
-#endif /* LASER_H_ */
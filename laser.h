@@ -1,47 +1,63 @@
 #ifndef LASER_H_
 #define LASER_H_
 
-#define LASER_VELOCITY_MAX 10
-
+#include "config.h"
+#include "entity.h"
 #include <display.h>
 #include <stdbool.h>
 #include <stdint.h>
 
-struct Laser {
-  int16_t x;
-  int16_t y;
-  int8_t xVelocity;
-  int8_t yVelocity;
-  uint8_t radius;
-  bool collision;
-  struct Laser *previousLaser;
-  struct Laser *nextLaser;
-  uint8_t lifeCounter;
-};
+// How fast a laser travels, in pixels per second, and the same speed as a
+// whole number of pixels per tick.
+#define LASER_SPEED 100
+#define LASER_VELOCITY_MAX ((int8_t)(CONFIG_PER_TICK(LASER_SPEED) + 0.5))
+
+// Number of lasers that can be in flight at once. The ship fires at most
+// once every few ticks and a laser lives a couple of seconds (see laser.c),
+// so about seven are ever in flight on the board. Host stress builds raise
+// this.
+#ifndef MAX_LASER_COUNT
+#define MAX_LASER_COUNT 16
+#endif
 
 // it adds an laser. What's there to explain?
-struct Laser *laser_addLaser(int16_t myX, int16_t myY, int8_t myXVelocity,
-                             int8_t myYVelocity);
+// Storage is fixed at MAX_LASER_COUNT; when it is full nothing is added and
+// false is returned.
+bool laser_addLaser(int16_t myX, int16_t myY, int8_t myXVelocity,
+                    int8_t myYVelocity);
 
 void laser_enable();
 
 void laser_disable();
 
-void laser_collision(struct Laser *laser);
+// Flag the laser as having hit something. It stops where it is, is no longer
+// drawn and expires as usual. Does nothing if the laser is already gone.
+void laser_collision(entity_handle_t laser);
 
 // starts laser state machine, it doesn't really have that much to do
 void laser_init();
 
-// standard tick function, capable of adding, drawing, moving, and destroying
-// laser as dictated by control program
+// standard tick function, capable of adding, moving, and destroying laser as
+// dictated by control program
 void laser_tick();
 
-uint8_t laser_getCount();
+// Submit every laser in flight to the render stage, drawn alpha of the way
+// (see RENDER_ALPHA_ONE) through its last move. Call once per frame.
+void laser_draw(uint16_t alpha);
 
-struct Laser *laser_getHeadLaser();
+uint16_t laser_getCount();
 
-struct Laser *laser_getTailLaser();
+// Get read-only access to every laser in flight (see entity.h), oldest first.
+// previousX and previousY hold where each laser started its last move, for
+// sweeping its path. Indices are only good until the next laser_tick.
+entity_view_t laser_getView();
+
+// Handle of the laser at index of the view; ENTITY_HANDLE_NONE past the end.
+entity_handle_t laser_getHandle(uint16_t index);
 
 void laser_eraseAll();
 
+// Fold the laser state into hash (see stateHash.h) and return the result.
+uint32_t laser_hashState(uint32_t hash);
+
 #endif /* LASER_H_ */
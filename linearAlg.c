@@ -3,10 +3,26 @@
 #include <stdint.h>
 #include <stdio.h>
 
+// Pick a kernel for the batched functions. Doubles need 64-bit float lanes,
+// which NEON only has on AArch64. Fixed point needs a signed 32x32->64 bit
+// multiply, which NEON has but SSE2 lacks, so x86 needs AVX2 for it.
+#if !defined(LINEARALG_FORCE_SCALAR) && defined(__ARM_NEON) &&                \
+    (CONFIG_LINEARALG_FIXED_POINT || defined(__aarch64__))
+#define LINEARALG_USE_NEON
+#include <arm_neon.h>
+#elif !defined(LINEARALG_FORCE_SCALAR) && defined(__AVX2__)
+#define LINEARALG_USE_AVX2
+#include <immintrin.h>
+#elif !defined(LINEARALG_FORCE_SCALAR) && defined(__SSE2__) &&                \
+    !CONFIG_LINEARALG_FIXED_POINT
+#define LINEARALG_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #define SQUARE_EXP 2 // The value of the exponent to square a number.
 
 // Function Declarations.
-elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2);
+static inline elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2);
 
 // A function that calculates the given vector left multiplied by the given
 // matrix. This will be used to calculate rotations.
@@ -21,8 +37,25 @@ void linearAlg_matVectMultAx2D(matrix2x2_t matrix, vector2D_t *vector) {
   *vector = tempVector;
 }
 
+#if CONFIG_LINEARALG_FIXED_POINT
+// Calculate the dot product of two vectors vect1 and vect2. The sum is kept
+// at full precision and rounded once.
+static inline elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2) {
+  int64_t sum = (int64_t)vect1.x * vect2.x + (int64_t)vect1.y * vect2.y;
+  return (elementSize_t)((sum + (LINEARALG_ONE / 2)) >>
+                         LINEARALG_FRACTION_BITS);
+}
+
+// Return the magnitude of a vector of type vector2D_t. The squared length of
+// a Q16.16 vector is Q32.32, whose square root is already Q16.16.
+elementSize_t linearAlg_calcMag(vector2D_t vector) {
+  uint64_t x = (uint64_t)((int64_t)vector.x * vector.x);
+  uint64_t y = (uint64_t)((int64_t)vector.y * vector.y);
+  return (elementSize_t)linearAlg_isqrt(x + y);
+}
+#else
 // Calculate the dot product of two vectors vect1 and vect2.
-elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2) {
+static inline elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2) {
   return ((vect1.x * vect2.x) + (vect1.y * vect2.y));
 }
 
@@ -30,15 +63,328 @@ elementSize_t dotProduct(vector2D_t vect1, vector2D_t vect2) {
 elementSize_t linearAlg_calcMag(vector2D_t vector) {
   return sqrt(dotProduct(vector, vector));
 }
+#endif
 
 // Return a normalized vector based upon the direction and magnitude.
 vector2D_t linearAlg_normVect(vector2D_t vector, elementSize_t magnitude) {
   // Check if the magnitude is greater than to zero. If so then return the
   // normal. Else return a zero vector.
   if (magnitude > 0) {
+#if CONFIG_LINEARALG_FIXED_POINT
+    // One division for the reciprocal, kept with 32 fraction bits so the
+    // two multiplies lose nothing a direct division would keep.
+    int64_t reciprocal = ((int64_t)1 << 48) / magnitude;
+    return (vector2D_t){
+        .x = (elementSize_t)((vector.x * reciprocal + ((int64_t)1 << 31)) >>
+                             32),
+        .y = (elementSize_t)((vector.y * reciprocal + ((int64_t)1 << 31)) >>
+                             32)};
+#else
     return (vector2D_t){.x = (vector.x / magnitude),
                         .y = (vector.y / magnitude)};
+#endif
   } else {
     return (vector2D_t){.x = 0, .y = 0};
   }
-}
\ No newline at end of file
+}
+
+// Return the floor of the square root of value, working out one bit of the
+// root per step from the most significant down.
+uint32_t linearAlg_isqrt(uint64_t value) {
+  if (value == 0) {
+    return 0;
+  }
+  // Start at the highest power of four not above value.
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << ((63 - __builtin_clzll(value)) & ~1);
+  while (bit != 0) {
+    // All ones when this bit belongs in the root. Masking instead of
+    // branching keeps the loop free of unpredictable jumps.
+    uint64_t trial = root + bit;
+    uint64_t taken = -(uint64_t)(value >= trial);
+    value -= trial & taken;
+    root = (root >> 1) + (bit & taken);
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+// Portable versions of the batched functions. Each element gives exactly the
+// same result as the single-vector functions, and the vector kernels below
+// match them bit for bit.
+static void linearAlg_transformArrayScalar(matrix2x2_t matrix,
+                                           const vector2D_t *in,
+                                           vector2D_t *out, uint16_t first,
+                                           uint16_t count) {
+  for (uint16_t i = first; i < count; i++) {
+    vector2D_t vector = in[i];
+    linearAlg_matVectMultAx2D(matrix, &vector);
+    out[i] = vector;
+  }
+}
+
+static void linearAlg_magnitudeArrayScalar(const vector2D_t *in,
+                                           elementSize_t *out, uint16_t first,
+                                           uint16_t count) {
+  for (uint16_t i = first; i < count; i++) {
+    out[i] = linearAlg_calcMag(in[i]);
+  }
+}
+
+static void linearAlg_normalizeArrayScalar(const vector2D_t *in,
+                                           vector2D_t *out, uint16_t first,
+                                           uint16_t count) {
+  for (uint16_t i = first; i < count; i++) {
+    out[i] = linearAlg_normVect(in[i], linearAlg_calcMag(in[i]));
+  }
+}
+
+// Each kernel returns the index of the first element left for the scalar
+// loop. Magnitude and normalize have no fixed-point kernels: the integer
+// square root is a long serial loop with no vector form worth having.
+#if defined(LINEARALG_USE_NEON) && CONFIG_LINEARALG_FIXED_POINT
+// Two vectors per step. vld2 splits the x and y components into separate
+// registers and vrshrn does the same round-to-nearest as dotProduct.
+static uint16_t linearAlg_transformArrayVector(matrix2x2_t matrix,
+                                               const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    int32x2x2_t v = vld2_s32(&in[i].x);
+    int64x2_t x = vmlal_n_s32(vmull_n_s32(v.val[0], matrix.vect1.x), v.val[1],
+                              matrix.vect2.x);
+    int64x2_t y = vmlal_n_s32(vmull_n_s32(v.val[0], matrix.vect1.y), v.val[1],
+                              matrix.vect2.y);
+    int32x2x2_t result = {{vrshrn_n_s64(x, LINEARALG_FRACTION_BITS),
+                           vrshrn_n_s64(y, LINEARALG_FRACTION_BITS)}};
+    vst2_s32(&out[i].x, result);
+  }
+  return i;
+}
+#elif defined(LINEARALG_USE_NEON)
+// Two vectors per step, with x and y components split by vld2.
+static uint16_t linearAlg_transformArrayVector(matrix2x2_t matrix,
+                                               const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    float64x2x2_t v = vld2q_f64(&in[i].x);
+    float64x2x2_t result = {
+        {vaddq_f64(vmulq_n_f64(v.val[0], matrix.vect1.x),
+                   vmulq_n_f64(v.val[1], matrix.vect2.x)),
+         vaddq_f64(vmulq_n_f64(v.val[0], matrix.vect1.y),
+                   vmulq_n_f64(v.val[1], matrix.vect2.y))}};
+    vst2q_f64(&out[i].x, result);
+  }
+  return i;
+}
+
+static uint16_t linearAlg_magnitudeArrayVector(const vector2D_t *in,
+                                               elementSize_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    float64x2x2_t v = vld2q_f64(&in[i].x);
+    float64x2_t squared = vaddq_f64(vmulq_f64(v.val[0], v.val[0]),
+                                    vmulq_f64(v.val[1], v.val[1]));
+    vst1q_f64(&out[i], vsqrtq_f64(squared));
+  }
+  return i;
+}
+
+// Zero-length vectors come out as zero, like linearAlg_normVect.
+static uint16_t linearAlg_normalizeArrayVector(const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    float64x2x2_t v = vld2q_f64(&in[i].x);
+    float64x2_t magnitude = vsqrtq_f64(vaddq_f64(
+        vmulq_f64(v.val[0], v.val[0]), vmulq_f64(v.val[1], v.val[1])));
+    uint64x2_t nonZero = vcgtq_f64(magnitude, vdupq_n_f64(0));
+    float64x2x2_t result = {
+        {vreinterpretq_f64_u64(vandq_u64(
+             nonZero, vreinterpretq_u64_f64(vdivq_f64(v.val[0], magnitude)))),
+         vreinterpretq_f64_u64(vandq_u64(
+             nonZero, vreinterpretq_u64_f64(vdivq_f64(v.val[1], magnitude))))}};
+    vst2q_f64(&out[i].x, result);
+  }
+  return i;
+}
+#elif defined(LINEARALG_USE_AVX2) && CONFIG_LINEARALG_FIXED_POINT
+// Two vectors per step, widened to four 64-bit lanes (x0, y0, x1, y1).
+// mul_epi32 multiplies the signed low halves of each lane. A logical shift is
+// fine for the rounding step because only the low 32 bits of the result are
+// kept.
+static uint16_t linearAlg_transformArrayVector(matrix2x2_t matrix,
+                                               const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  const __m256i column1 = _mm256_setr_epi64x(matrix.vect1.x, matrix.vect1.y,
+                                             matrix.vect1.x, matrix.vect1.y);
+  const __m256i column2 = _mm256_setr_epi64x(matrix.vect2.x, matrix.vect2.y,
+                                             matrix.vect2.x, matrix.vect2.y);
+  const __m256i half = _mm256_set1_epi64x(LINEARALG_ONE / 2);
+  const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m256i v = _mm256_cvtepi32_epi64(
+        _mm_loadu_si128((const __m128i *)&in[i].x));
+    __m256i x = _mm256_unpacklo_epi64(v, v); // x0, x0, x1, x1
+    __m256i y = _mm256_unpackhi_epi64(v, v); // y0, y0, y1, y1
+    __m256i sum = _mm256_add_epi64(_mm256_mul_epi32(x, column1),
+                                   _mm256_mul_epi32(y, column2));
+    sum = _mm256_srli_epi64(_mm256_add_epi64(sum, half),
+                            LINEARALG_FRACTION_BITS);
+    __m256i packed = _mm256_permutevar8x32_epi32(sum, lowHalves);
+    _mm_storeu_si128((__m128i *)&out[i].x, _mm256_castsi256_si128(packed));
+  }
+  return i;
+}
+#elif defined(LINEARALG_USE_AVX2)
+// Two vectors per step, held as (x0, y0, x1, y1).
+static uint16_t linearAlg_transformArrayVector(matrix2x2_t matrix,
+                                               const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  const __m256d column1 = _mm256_setr_pd(matrix.vect1.x, matrix.vect1.y,
+                                         matrix.vect1.x, matrix.vect1.y);
+  const __m256d column2 = _mm256_setr_pd(matrix.vect2.x, matrix.vect2.y,
+                                         matrix.vect2.x, matrix.vect2.y);
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m256d v = _mm256_loadu_pd(&in[i].x);
+    __m256d x = _mm256_unpacklo_pd(v, v); // x0, x0, x1, x1
+    __m256d y = _mm256_unpackhi_pd(v, v); // y0, y0, y1, y1
+    _mm256_storeu_pd(&out[i].x, _mm256_add_pd(_mm256_mul_pd(x, column1),
+                                              _mm256_mul_pd(y, column2)));
+  }
+  return i;
+}
+
+// Four vectors per step. The unpacks leave the lanes in the order 0, 2, 1, 3,
+// which the final permute undoes.
+static uint16_t linearAlg_magnitudeArrayVector(const vector2D_t *in,
+                                               elementSize_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d a = _mm256_loadu_pd(&in[i].x);
+    __m256d b = _mm256_loadu_pd(&in[i + 2].x);
+    __m256d x = _mm256_unpacklo_pd(a, b);
+    __m256d y = _mm256_unpackhi_pd(a, b);
+    __m256d magnitude = _mm256_sqrt_pd(
+        _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)));
+    _mm256_storeu_pd(&out[i],
+                     _mm256_permute4x64_pd(magnitude, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  return i;
+}
+
+// Two vectors per step. hadd puts each vector's squared length in both of its
+// lanes. Zero-length vectors come out as zero, like linearAlg_normVect.
+static uint16_t linearAlg_normalizeArrayVector(const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m256d v = _mm256_loadu_pd(&in[i].x);
+    __m256d squared = _mm256_mul_pd(v, v);
+    __m256d magnitude = _mm256_sqrt_pd(_mm256_hadd_pd(squared, squared));
+    __m256d nonZero =
+        _mm256_cmp_pd(magnitude, _mm256_setzero_pd(), _CMP_GT_OQ);
+    _mm256_storeu_pd(&out[i].x,
+                     _mm256_and_pd(nonZero, _mm256_div_pd(v, magnitude)));
+  }
+  return i;
+}
+#elif defined(LINEARALG_USE_SSE2)
+// One vector per step, held as (x, y).
+static uint16_t linearAlg_transformArrayVector(matrix2x2_t matrix,
+                                               const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  const __m128d column1 = _mm_setr_pd(matrix.vect1.x, matrix.vect1.y);
+  const __m128d column2 = _mm_setr_pd(matrix.vect2.x, matrix.vect2.y);
+  uint16_t i = 0;
+  for (; i < count; i++) {
+    __m128d v = _mm_loadu_pd(&in[i].x);
+    __m128d x = _mm_unpacklo_pd(v, v);
+    __m128d y = _mm_unpackhi_pd(v, v);
+    _mm_storeu_pd(&out[i].x,
+                  _mm_add_pd(_mm_mul_pd(x, column1), _mm_mul_pd(y, column2)));
+  }
+  return i;
+}
+
+// Two vectors per step, with the x and y components gathered by unpacking.
+static uint16_t linearAlg_magnitudeArrayVector(const vector2D_t *in,
+                                               elementSize_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d a = _mm_loadu_pd(&in[i].x);
+    __m128d b = _mm_loadu_pd(&in[i + 1].x);
+    __m128d x = _mm_unpacklo_pd(a, b);
+    __m128d y = _mm_unpackhi_pd(a, b);
+    _mm_storeu_pd(&out[i],
+                  _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y))));
+  }
+  return i;
+}
+
+// One vector per step. Zero-length vectors come out as zero, like
+// linearAlg_normVect.
+static uint16_t linearAlg_normalizeArrayVector(const vector2D_t *in,
+                                               vector2D_t *out,
+                                               uint16_t count) {
+  uint16_t i = 0;
+  for (; i < count; i++) {
+    __m128d v = _mm_loadu_pd(&in[i].x);
+    __m128d squared = _mm_mul_pd(v, v);
+    __m128d magnitude = _mm_sqrt_pd(
+        _mm_add_pd(squared, _mm_shuffle_pd(squared, squared, 1)));
+    __m128d nonZero = _mm_cmpgt_pd(magnitude, _mm_setzero_pd());
+    _mm_storeu_pd(&out[i].x, _mm_and_pd(nonZero, _mm_div_pd(v, magnitude)));
+  }
+  return i;
+}
+#endif
+
+// Multiply every vector in in by matrix, like linearAlg_matVectMultAx2D.
+void linearAlg_transformArray(matrix2x2_t matrix, const vector2D_t *in,
+                              vector2D_t *out, uint16_t count) {
+  uint16_t first = 0;
+#if defined(LINEARALG_USE_NEON) || defined(LINEARALG_USE_AVX2) ||             \
+    defined(LINEARALG_USE_SSE2)
+  first = linearAlg_transformArrayVector(matrix, in, out, count);
+#endif
+  linearAlg_transformArrayScalar(matrix, in, out, first, count);
+}
+
+// Store the magnitude of every vector in in, like linearAlg_calcMag.
+void linearAlg_magnitudeArray(const vector2D_t *in, elementSize_t *out,
+                              uint16_t count) {
+  uint16_t first = 0;
+#if !CONFIG_LINEARALG_FIXED_POINT &&                                           \
+    (defined(LINEARALG_USE_NEON) || defined(LINEARALG_USE_AVX2) ||             \
+     defined(LINEARALG_USE_SSE2))
+  first = linearAlg_magnitudeArrayVector(in, out, count);
+#endif
+  linearAlg_magnitudeArrayScalar(in, out, first, count);
+}
+
+// Scale every vector in in to unit length, like linearAlg_normVect with the
+// vector's own magnitude.
+void linearAlg_normalizeArray(const vector2D_t *in, vector2D_t *out,
+                              uint16_t count) {
+  uint16_t first = 0;
+#if !CONFIG_LINEARALG_FIXED_POINT &&                                           \
+    (defined(LINEARALG_USE_NEON) || defined(LINEARALG_USE_AVX2) ||             \
+     defined(LINEARALG_USE_SSE2))
+  first = linearAlg_normalizeArrayVector(in, out, count);
+#endif
+  linearAlg_normalizeArrayScalar(in, out, first, count);
+}
@@ -1,10 +1,43 @@
 #ifndef LINEARALG_H_
 #define LINEARALG_H_
 
+#include "config.h"
 #include <stdint.h>
 
+#if CONFIG_LINEARALG_FIXED_POINT
+// Q16.16: the low LINEARALG_FRACTION_BITS bits hold the fraction.
+typedef int32_t elementSize_t;
+
+#define LINEARALG_FRACTION_BITS 16
+#define LINEARALG_ONE ((elementSize_t)1 << LINEARALG_FRACTION_BITS)
+
+// Convert to and from elementSize_t. Constants should go through
+// LINEARALG_FROM_DOUBLE so the compiler folds them; it rounds to nearest.
+#define LINEARALG_FROM_INT(i) ((elementSize_t)(i) * LINEARALG_ONE)
+#define LINEARALG_FROM_DOUBLE(d)                                               \
+  ((elementSize_t)((d) * LINEARALG_ONE + ((d) < 0 ? -0.5 : 0.5)))
+// Truncates toward zero, like casting a double.
+#define LINEARALG_TO_INT(v)                                                    \
+  ((int16_t)((v) < 0 ? -(-(v) >> LINEARALG_FRACTION_BITS)                      \
+                     : (v) >> LINEARALG_FRACTION_BITS))
+
+// Multiply and divide, rounding the product to nearest. Both go through 64
+// bits so intermediate values cannot overflow.
+#define LINEARALG_MUL(a, b)                                                    \
+  ((elementSize_t)(((int64_t)(a) * (b) + (LINEARALG_ONE / 2)) >>              \
+                   LINEARALG_FRACTION_BITS))
+#define LINEARALG_DIV(a, b)                                                    \
+  ((elementSize_t)((int64_t)(a) * LINEARALG_ONE / (b)))
+#else
 typedef double elementSize_t;
 
+#define LINEARALG_FROM_INT(i) ((elementSize_t)(i))
+#define LINEARALG_FROM_DOUBLE(d) ((elementSize_t)(d))
+#define LINEARALG_TO_INT(v) ((int16_t)(v))
+#define LINEARALG_MUL(a, b) ((a) * (b))
+#define LINEARALG_DIV(a, b) ((a) / (b))
+#endif
+
 // Declaration of a struct to hold a 2D vector.
 typedef struct {
   elementSize_t x;
@@ -27,4 +60,19 @@ elementSize_t linearAlg_calcMag(vector2D_t vector);
 // Return a normalized vector based upon the direction and magnitude.
 vector2D_t linearAlg_normVect(vector2D_t vector, elementSize_t magnitude);
 
-#endif // LINEARALG_H_
\ No newline at end of file
+// Return the floor of the square root of value using only integer operations.
+uint32_t linearAlg_isqrt(uint64_t value);
+
+// Batched versions of the functions above, for count vectors at a time. in and
+// out may be the same array. Each element gets exactly the result the
+// single-vector function would give. Uses NEON, AVX2 or SSE2 kernels when the
+// compiler targets them (fixed point: transform only, on NEON or AVX2);
+// define LINEARALG_FORCE_SCALAR to always use the portable loops.
+void linearAlg_transformArray(matrix2x2_t matrix, const vector2D_t *in,
+                              vector2D_t *out, uint16_t count);
+void linearAlg_magnitudeArray(const vector2D_t *in, elementSize_t *out,
+                              uint16_t count);
+void linearAlg_normalizeArray(const vector2D_t *in, vector2D_t *out,
+                              uint16_t count);
+
+#endif // LINEARALG_H_
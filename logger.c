@@ -0,0 +1,171 @@
+#include "logger.h"
+#include "loggerMessages.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define RING_MASK (LOGGER_RING_SIZE - 1)
+_Static_assert((LOGGER_RING_SIZE & RING_MASK) == 0,
+               "LOGGER_RING_SIZE must be a power of two");
+
+// Records handled per logger_drain call, so one call stays short.
+#define DRAIN_BATCH 16
+#define TEXT_SIZE 96
+
+// Binary log layout: the bytes 'A' 'L' 'G' then VERSION, followed by
+// records of RECORD_SIZE bytes: tick (4), message (2), level (1), a (4) and
+// b (4), little endian.
+#define VERSION 1
+#define HEADER_SIZE 4
+#define RECORD_SIZE 15
+
+#define LOGGER_MESSAGE_FORMAT(id, format) format,
+
+static const char *const formats[LOGGER_MESSAGE_COUNT] = {
+    LOGGER_MESSAGES(LOGGER_MESSAGE_FORMAT)};
+
+static const char *const levelNames[] = {"", "ERROR", "WARN", "INFO",
+                                         "DEBUG"};
+
+static const uint8_t header[HEADER_SIZE] = {'A', 'L', 'G', VERSION};
+
+// Single-producer single-consumer ring. head and tail count records written
+// and read since logger_init and only ever grow; the writer owns head and
+// the reader owns tail, so neither side needs a lock. The release store of
+// one and the acquire load of the other order the record copy.
+static logger_record_t ring[LOGGER_RING_SIZE];
+static atomic_uint head;
+static atomic_uint tail;
+static uint32_t currentTick;
+static uint32_t droppedCount;
+static FILE *binaryOutput;
+
+// Empty the ring buffer and reset the tick count and drop counter.
+void logger_init() {
+  atomic_store(&head, 0);
+  atomic_store(&tail, 0);
+  currentTick = 0;
+  droppedCount = 0;
+}
+
+// Note that a game tick has started.
+void logger_advanceTick() { currentTick++; }
+
+// Append a record, or count it as dropped if the ring is full.
+void logger_write(uint8_t level, uint16_t message, int32_t a, int32_t b) {
+  unsigned int write = atomic_load_explicit(&head, memory_order_relaxed);
+  unsigned int read = atomic_load_explicit(&tail, memory_order_acquire);
+  if (write - read >= LOGGER_RING_SIZE) {
+    droppedCount++;
+    return;
+  }
+  ring[write & RING_MASK] = (logger_record_t){
+      .tick = currentTick, .message = message, .level = level, .a = a, .b = b};
+  atomic_store_explicit(&head, write + 1, memory_order_release);
+}
+
+// Take the oldest record.
+bool logger_read(logger_record_t *record) {
+  unsigned int read = atomic_load_explicit(&tail, memory_order_relaxed);
+  unsigned int write = atomic_load_explicit(&head, memory_order_acquire);
+  if (read == write) {
+    return false;
+  }
+  *record = ring[read & RING_MASK];
+  atomic_store_explicit(&tail, read + 1, memory_order_release);
+  return true;
+}
+
+bool logger_isEmpty() {
+  return atomic_load_explicit(&head, memory_order_acquire) ==
+         atomic_load_explicit(&tail, memory_order_relaxed);
+}
+
+uint32_t logger_getDroppedCount() { return droppedCount; }
+
+// Send binary records to file from now on.
+bool logger_setBinaryOutput(FILE *file) {
+  binaryOutput = file;
+  return file == NULL || fwrite(header, sizeof header, 1, file) == 1;
+}
+
+// Write one record in the binary layout.
+static void logger_writeBinary(const logger_record_t *record) {
+  uint8_t bytes[RECORD_SIZE] = {
+      (uint8_t)record->tick,         (uint8_t)(record->tick >> 8),
+      (uint8_t)(record->tick >> 16), (uint8_t)(record->tick >> 24),
+      (uint8_t)record->message,      (uint8_t)(record->message >> 8),
+      record->level,                 (uint8_t)record->a,
+      (uint8_t)(record->a >> 8),     (uint8_t)(record->a >> 16),
+      (uint8_t)(record->a >> 24),    (uint8_t)record->b,
+      (uint8_t)(record->b >> 8),     (uint8_t)(record->b >> 16),
+      (uint8_t)(record->b >> 24)};
+  fwrite(bytes, sizeof bytes, 1, binaryOutput);
+}
+
+// Empty up to DRAIN_BATCH records to the output.
+void logger_drain() {
+  logger_record_t record;
+  for (uint8_t i = 0; i < DRAIN_BATCH && logger_read(&record); i++) {
+    if (binaryOutput != NULL) {
+      logger_writeBinary(&record);
+    } else {
+      char text[TEXT_SIZE];
+      logger_format(&record, text, sizeof text);
+      puts(text);
+    }
+  }
+}
+
+// Format a record as "[tick] LEVEL message".
+void logger_format(const logger_record_t *record, char *text, size_t size) {
+  const char *level =
+      record->level <= LOG_LEVEL_DEBUG ? levelNames[record->level] : "?";
+  int length =
+      snprintf(text, size, "[%lu] %s ", (unsigned long)record->tick, level);
+  if (length < 0 || (size_t)length >= size) {
+    return;
+  }
+  if (record->message >= LOGGER_MESSAGE_COUNT) {
+    snprintf(text + length, size - length, "unknown message %u",
+             record->message);
+    return;
+  }
+  snprintf(text + length, size - length, formats[record->message],
+           (long)record->a, (long)record->b);
+}
+
+// Check the header of a binary log.
+bool logger_readHeader(FILE *file) {
+  uint8_t read[HEADER_SIZE];
+  if (fread(read, sizeof read, 1, file) != 1) {
+    return false;
+  }
+  for (uint8_t i = 0; i < HEADER_SIZE; i++) {
+    if (read[i] != header[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Read the next record of a binary log.
+bool logger_readRecord(FILE *file, logger_record_t *record) {
+  uint8_t bytes[RECORD_SIZE];
+  if (fread(bytes, sizeof bytes, 1, file) != 1) {
+    return false;
+  }
+  record->tick = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                 ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+  record->message = (uint16_t)(bytes[4] | (bytes[5] << 8));
+  record->level = bytes[6];
+  record->a = (int32_t)((uint32_t)bytes[7] | ((uint32_t)bytes[8] << 8) |
+                        ((uint32_t)bytes[9] << 16) |
+                        ((uint32_t)bytes[10] << 24));
+  record->b = (int32_t)((uint32_t)bytes[11] | ((uint32_t)bytes[12] << 8) |
+                        ((uint32_t)bytes[13] << 16) |
+                        ((uint32_t)bytes[14] << 24));
+  return true;
+}
@@ -0,0 +1,96 @@
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include "config.h"
+#include "loggerMessages.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Logging for the tick path. A call costs one small binary record in a
+// ring buffer; turning records into text happens later, in logger_drain (run
+// as an idle job) or in the host's asteroidsLogDecode tool.
+//
+// Calls below CONFIG_LOG_LEVEL compile to nothing, arguments included, so
+// they cost nothing at all in builds that leave them out.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#if CONFIG_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(message, a, b) logger_write(LOG_LEVEL_ERROR, message, a, b)
+#else
+#define LOG_ERROR(message, a, b) ((void)0)
+#endif
+#if CONFIG_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(message, a, b) logger_write(LOG_LEVEL_WARN, message, a, b)
+#else
+#define LOG_WARN(message, a, b) ((void)0)
+#endif
+#if CONFIG_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(message, a, b) logger_write(LOG_LEVEL_INFO, message, a, b)
+#else
+#define LOG_INFO(message, a, b) ((void)0)
+#endif
+#if CONFIG_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(message, a, b) logger_write(LOG_LEVEL_DEBUG, message, a, b)
+#else
+#define LOG_DEBUG(message, a, b) ((void)0)
+#endif
+
+// Records the ring buffer holds. A power of two; records written while it is
+// full are dropped and counted.
+#ifndef LOGGER_RING_SIZE
+#define LOGGER_RING_SIZE 256
+#endif
+
+// One logged call. The message id picks the format in loggerMessages.h.
+typedef struct {
+  uint32_t tick;
+  uint16_t message;
+  uint8_t level;
+  int32_t a;
+  int32_t b;
+} logger_record_t;
+
+// Empty the ring buffer and reset the tick count and drop counter.
+void logger_init();
+
+// Note that a game tick has started. Records are stamped with the count.
+void logger_advanceTick();
+
+// Append a record. Use the LOG_* macros rather than calling this directly.
+// Safe to call from one producer while one consumer drains; never blocks.
+void logger_write(uint8_t level, uint16_t message, int32_t a, int32_t b);
+
+// Take the oldest record. Returns false if the buffer is empty.
+bool logger_read(logger_record_t *record);
+
+bool logger_isEmpty();
+
+// Number of records dropped because the ring buffer was full.
+uint32_t logger_getDroppedCount();
+
+// Send binary records to file from now on instead of printing text, for
+// asteroidsLogDecode to format later. The header is written here. NULL goes
+// back to text. Returns false on a write error.
+bool logger_setBinaryOutput(FILE *file);
+
+// Empty the ring buffer to the output: printed text (the UART on the board),
+// or binary records if logger_setBinaryOutput chose a file. Meant to run as
+// an idle job (see scheduler.h).
+void logger_drain();
+
+// Format a record as one line of text, without the newline. Output is cut
+// short to fit size.
+void logger_format(const logger_record_t *record, char *text, size_t size);
+
+// Read the header of a binary log, then records one at a time. readRecord
+// returns false at the end of the file or on a short record.
+bool logger_readHeader(FILE *file);
+bool logger_readRecord(FILE *file, logger_record_t *record);
+
+#endif /* LOGGER_H_ */
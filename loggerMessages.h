@@ -0,0 +1,40 @@
+#ifndef LOGGERMESSAGES_H_
+#define LOGGERMESSAGES_H_
+
+// Every message the game can log, as X(id, format). Records carry only the
+// id and two arguments; the format string is applied when the record is
+// drained or decoded, so it never costs anything on the tick path. Formats
+// may use up to two %ld conversions. Add new messages at the end so ids in
+// saved logs keep their meaning.
+#define LOGGER_MESSAGES(X)                                                     \
+  X(logger_asteroidEnabled, "asteroids enabled")                               \
+  X(logger_asteroidDisabled, "asteroids disabled")                             \
+  X(logger_asteroidInitState, "asteroid_init_st")                              \
+  X(logger_asteroidPlayState, "asteroid_play_st")                              \
+  X(logger_laserEnabled, "lasers enabled")                                     \
+  X(logger_laserDisabled, "lasers disabled")                                   \
+  X(logger_laserInitState, "laser_init_st")                                    \
+  X(logger_laserPlayState, "laser_play_st")                                    \
+  X(logger_fireButton, "FIRE BUTTON")                                          \
+  X(logger_thrustButton, "THRUST BUTTON")                                      \
+  X(logger_leftAndRightButtons, "LEFT AND RIGHT BUTTONS")                      \
+  X(logger_leftButton, "LEFT BUTTON")                                          \
+  X(logger_rightButton, "RIGHT BUTTON")                                        \
+  X(logger_laserCollision, "laser collision with asteroid %ld")                \
+  X(logger_shipCollision, "ship collision with asteroid %ld")                  \
+  X(logger_gameInitState, "game_init_st")                                      \
+  X(logger_gameWelcomeState, "game_welcome_st")                                \
+  X(logger_gamePlayState, "game_play_st")                                      \
+  X(logger_gameNextLevelState, "game_next_level_st")                           \
+  X(logger_gameDeathState, "game_death_st")                                    \
+  X(logger_gameOverState, "game_over_st")                                      \
+  X(logger_gamePlayAgainState, "game_play_again_st")                           \
+  X(logger_errorState, "unknown state %ld")
+
+#define LOGGER_MESSAGE_ID(id, format) id,
+
+typedef enum {
+  LOGGER_MESSAGES(LOGGER_MESSAGE_ID) LOGGER_MESSAGE_COUNT
+} logger_message_t;
+
+#endif /* LOGGERMESSAGES_H_ */
@@ -17,10 +17,14 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 #include "config.h"
 #include "display.h"
 #include "game.h"
+#include "gameLoop.h"
 #include "interrupts.h"
 #include "intervalTimer.h"
 #include "laser.h"
 #include "leds.h"
+#include "logger.h"
+#include "profiler.h"
+#include "scheduler.h"
 #include "spaceship.h"
 #include "utils.h"
 #include "xparameters.h"
@@ -59,19 +63,9 @@ For questions, contact Brad Hutchings or Jeff Goeders, https://ece.byu.edu/
 
 static uint32_t randomSeed; // Used to make the game seem more random.
 
-static void test_init() {
-  asteroid_init();
-  laser_init();
-  spaceship_init();
-  game_init();
-}
+static void test_init() { gameLoop_init(); }
 
-void tickAll() {
-  asteroid_tick();
-  laser_tick();
-  spaceship_tick();
-  game_tick();
-}
+void tickAll() { gameLoop_frame(); }
 
 int main() {
   test_init();
@@ -86,9 +80,7 @@ int main() {
   interrupts_startArmPrivateTimer();
   // Enable interrupts at the ARM.
   interrupts_enableArmInts();
-  uint8_t counter = 0;
   while (1) {
-    counter++;
     if (interrupts_isrFlagGlobal) {
       // Count ticks.
       // personalInterruptCount++;
@@ -96,12 +88,26 @@ int main() {
       interrupts_isrFlagGlobal = 0;
       if (personalInterruptCount >= MAX_INTERRUPT_COUNT)
         break;
+    }
+    // Spend the slack on deferred jobs. The private timer counts down to the
+    // next frame, so its value is the time left.
+    scheduler_runIdle(interrupts_getPrivateTimerCounterValue());
+    // Sleep (WFI) until the next interrupt. Interrupts are masked around the
+    // check so the timer cannot fire between it and the WFI; a pending
+    // interrupt still wakes the core and is taken once they are unmasked.
+    interrupts_disableArmInts();
+    if (!interrupts_isrFlagGlobal) {
       utils_sleep();
     }
+    interrupts_enableArmInts();
   }
   interrupts_disableArmInts();
+  while (!logger_isEmpty()) {
+    logger_drain();
+  }
   printf("isr invocation count: %d\n", interrupts_isrInvocationCount());
   printf("internal interrupt count: %d\n", personalInterruptCount);
+  profiler_dump();
   return 0;
 }
 
@@ -0,0 +1,85 @@
+#include "motion.h"
+#include <stdint.h>
+
+#if !defined(MOTION_FORCE_SCALAR) &&                                          \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define MOTION_USE_NEON
+#include <arm_neon.h>
+#elif !defined(MOTION_FORCE_SCALAR) && defined(__SSE2__)
+#define MOTION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#define MOTION_LANES 8 // int16_t elements per 128-bit vector.
+
+// Portable version of the kernel. Written as selects rather than branches so
+// the compiler is free to vectorize it on targets without an explicit path.
+static void motion_wrapAxisScalar(int16_t *position, const int8_t *velocity,
+                                  const uint8_t *radius, uint16_t first,
+                                  uint16_t count, int16_t extent) {
+  for (uint16_t i = first; i < count; i++) {
+    int16_t p = position[i];
+    int16_t r = radius[i];
+    int16_t moved = p + velocity[i];
+    int16_t wrapped = (p >= extent + r) ? 0 : moved;
+    position[i] = (p <= -r) ? extent : wrapped;
+  }
+}
+
+#if defined(MOTION_USE_NEON)
+// Returns the index of the first element left for the scalar loop.
+static uint16_t motion_wrapAxisVector(int16_t *position, const int8_t *velocity,
+                                      const uint8_t *radius, uint16_t count,
+                                      int16_t extent) {
+  int16x8_t extentVect = vdupq_n_s16(extent);
+  int16x8_t zeroVect = vdupq_n_s16(0);
+  uint16_t i = 0;
+  for (; i + MOTION_LANES <= count; i += MOTION_LANES) {
+    int16x8_t p = vld1q_s16(&position[i]);
+    int16x8_t v = vmovl_s8(vld1_s8(&velocity[i]));
+    int16x8_t r = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(&radius[i])));
+    uint16x8_t low = vcleq_s16(p, vnegq_s16(r));
+    uint16x8_t high = vcgeq_s16(p, vaddq_s16(extentVect, r));
+    int16x8_t out = vbslq_s16(high, zeroVect, vaddq_s16(p, v));
+    vst1q_s16(&position[i], vbslq_s16(low, extentVect, out));
+  }
+  return i;
+}
+#elif defined(MOTION_USE_SSE2)
+// Returns the index of the first element left for the scalar loop.
+static uint16_t motion_wrapAxisVector(int16_t *position, const int8_t *velocity,
+                                      const uint8_t *radius, uint16_t count,
+                                      int16_t extent) {
+  const __m128i zeroVect = _mm_setzero_si128();
+  const __m128i oneVect = _mm_set1_epi16(1);
+  const __m128i extentVect = _mm_set1_epi16(extent);
+  const __m128i extentLessOneVect = _mm_set1_epi16(extent - 1);
+  uint16_t i = 0;
+  for (; i + MOTION_LANES <= count; i += MOTION_LANES) {
+    __m128i p = _mm_loadu_si128((const __m128i *)&position[i]);
+    // Widen the 8 signed velocities and 8 unsigned radii to 16 bits.
+    __m128i v8 = _mm_loadl_epi64((const __m128i *)&velocity[i]);
+    __m128i v = _mm_srai_epi16(_mm_unpacklo_epi8(v8, v8), 8);
+    __m128i r8 = _mm_loadl_epi64((const __m128i *)&radius[i]);
+    __m128i r = _mm_unpacklo_epi8(r8, zeroVect);
+    // p <= -r is p < 1 - r, and p >= extent + r is p > extent - 1 + r.
+    __m128i low = _mm_cmpgt_epi16(_mm_sub_epi16(oneVect, r), p);
+    __m128i high = _mm_cmpgt_epi16(p, _mm_add_epi16(extentLessOneVect, r));
+    __m128i moved =
+        _mm_andnot_si128(_mm_or_si128(low, high), _mm_add_epi16(p, v));
+    __m128i out = _mm_or_si128(moved, _mm_and_si128(low, extentVect));
+    _mm_storeu_si128((__m128i *)&position[i], out);
+  }
+  return i;
+}
+#endif
+
+// Apply one tick of velocity with screen wrap to a whole axis at once.
+void motion_wrapAxis(int16_t *position, const int8_t *velocity,
+                     const uint8_t *radius, uint16_t count, int16_t extent) {
+  uint16_t first = 0;
+#if defined(MOTION_USE_NEON) || defined(MOTION_USE_SSE2)
+  first = motion_wrapAxisVector(position, velocity, radius, count, extent);
+#endif
+  motion_wrapAxisScalar(position, velocity, radius, first, count, extent);
+}
@@ -0,0 +1,18 @@
+#ifndef MOTION_H_
+#define MOTION_H_
+
+#include <stdint.h>
+
+// Batch movement kernel shared by the entity stores. For every element i in
+// [0, count) along one axis:
+//   if position[i] <= -radius[i]             position[i] = extent
+//   else if position[i] >= extent + radius[i] position[i] = 0
+//   else                                       position[i] += velocity[i]
+// This is the same screen wrap the per-object move functions always used, so
+// call it once with DISPLAY_WIDTH for x and once with DISPLAY_HEIGHT for y.
+// Uses NEON or SSE2 when the compiler targets them; define
+// MOTION_FORCE_SCALAR to always use the portable loop.
+void motion_wrapAxis(int16_t *position, const int8_t *velocity,
+                     const uint8_t *radius, uint16_t count, int16_t extent);
+
+#endif /* MOTION_H_ */
@@ -0,0 +1,18 @@
+#include "parallel.h"
+#include <stdint.h>
+
+// The board has a single core, so every loop runs in one piece on the caller.
+
+void parallel_init(uint8_t threadCount) { (void)threadCount; }
+
+uint8_t parallel_getThreadCount() { return 1; }
+
+void parallel_for(uint16_t count, uint16_t grain, parallel_job_t job,
+                  void *context) {
+  (void)grain;
+  if (count > 0) {
+    job(0, count, context);
+  }
+}
+
+uint8_t parallel_getWorker() { return 0; }
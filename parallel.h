@@ -0,0 +1,35 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <stdint.h>
+
+// Data-parallel loops for the per-entity phases of a tick. The board has one
+// core and runs every loop on it (parallel.c); the host build spreads them
+// over a pool of threads (host/). A job may only write the elements of its
+// own range, or per-worker scratch indexed by parallel_getWorker(), so the
+// results do not depend on how the range was split or on the thread count.
+// Anything that must happen in order (logging, score, spawning) is left to
+// the caller once the loop returns.
+
+// Runs a job over elements [begin, end) of whatever context describes.
+typedef void (*parallel_job_t)(uint16_t begin, uint16_t end, void *context);
+
+// Use threadCount threads, the caller included, clamped to
+// [1, CONFIG_PARALLEL_MAX_WORKERS]. Until this is called every loop runs on
+// the calling thread. Call once, before the first loop.
+void parallel_init(uint8_t threadCount);
+
+// Number of threads loops are spread over.
+uint8_t parallel_getThreadCount();
+
+// Run job over [0, count) and return when every element is done. The range
+// is cut into chunks of at least grain elements; a range too small to split
+// runs on the calling thread without waking anyone. Loops do not nest.
+void parallel_for(uint16_t count, uint16_t grain, parallel_job_t job,
+                  void *context);
+
+// Which thread is running the current job: 0 for the thread that called
+// parallel_for, and always below CONFIG_PARALLEL_MAX_WORKERS.
+uint8_t parallel_getWorker();
+
+#endif /* PARALLEL_H_ */
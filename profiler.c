@@ -0,0 +1,123 @@
+#include "profiler.h"
+#include "config.h"
+#include "profilerClock.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define US_PER_SECOND 1000000.0
+#define PERCENTILE 99
+
+// Buckets grow geometrically: four per power of two, so a bucket is never more
+// than 25% wider than its lower bound. Values below SUB_BUCKETS get a bucket
+// each. 32-bit times need 4 * 31 buckets.
+#define SUB_BUCKET_BITS 2
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define BUCKET_COUNT (SUB_BUCKETS * (32 - SUB_BUCKET_BITS + 1))
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[BUCKET_COUNT];
+} histogram_t;
+
+static histogram_t histograms[PROFILER_SECTION_COUNT];
+static uint32_t overrunCount;
+static uint32_t periodTicks;
+
+static const char *const sectionNames[PROFILER_SECTION_COUNT] = {
+    "input", "asteroid", "laser",   "spaceship", "game",
+    "tick",  "render",   "present", "frame"};
+
+// Index of the bucket holding value.
+static uint16_t profiler_bucketOf(uint32_t value) {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  uint8_t exponent = 31 - __builtin_clz(value);
+  uint8_t shift = exponent - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+// Largest value that falls in bucket.
+static uint32_t profiler_bucketTop(uint16_t bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  uint8_t shift = bucket / SUB_BUCKETS - 1;
+  uint64_t first = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+  return (uint32_t)(first + ((uint64_t)1 << shift) - 1);
+}
+
+// Upper bound of the bucket holding the given percentile, capped at the
+// largest time actually seen.
+static uint32_t profiler_percentile(const histogram_t *histogram,
+                                    uint8_t percentile) {
+  uint64_t target =
+      ((uint64_t)histogram->count * percentile + 99) / 100; // Round up.
+  uint64_t seen = 0;
+  for (uint16_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += histogram->buckets[i];
+    if (seen >= target) {
+      uint32_t top = profiler_bucketTop(i);
+      return top < histogram->max ? top : histogram->max;
+    }
+  }
+  return histogram->max;
+}
+
+static double profiler_toUs(double ticks) {
+  return ticks * US_PER_SECOND / profilerClock_ticksPerSecond();
+}
+
+// Clear every histogram and the overrun count.
+void profiler_init() {
+  memset(histograms, 0, sizeof histograms);
+  for (uint8_t i = 0; i < PROFILER_SECTION_COUNT; i++) {
+    histograms[i].min = UINT32_MAX;
+  }
+  overrunCount = 0;
+  periodTicks =
+      (uint32_t)(CONFIG_TIMER_PERIOD * profilerClock_ticksPerSecond());
+}
+
+// Add one timing to a section's histogram.
+void profiler_record(profiler_section_t section, uint32_t elapsed) {
+  if (section >= PROFILER_SECTION_COUNT) {
+    return;
+  }
+  histogram_t *histogram = &histograms[section];
+  histogram->count++;
+  histogram->sum += elapsed;
+  histogram->min = elapsed < histogram->min ? elapsed : histogram->min;
+  histogram->max = elapsed > histogram->max ? elapsed : histogram->max;
+  histogram->buckets[profiler_bucketOf(elapsed)]++;
+  if (section == profiler_frame && elapsed > periodTicks) {
+    overrunCount++;
+  }
+}
+
+uint32_t profiler_getOverrunCount() { return overrunCount; }
+
+// Print a table of every section that has been recorded.
+void profiler_dump() {
+  printf("%-10s %10s %10s %10s %10s %10s\n", "section", "count", "min(us)",
+         "mean(us)", "p99(us)", "max(us)");
+  for (uint8_t i = 0; i < PROFILER_SECTION_COUNT; i++) {
+    const histogram_t *histogram = &histograms[i];
+    if (histogram->count == 0) {
+      continue;
+    }
+    printf("%-10s %10lu %10.1f %10.1f %10.1f %10.1f\n", sectionNames[i],
+           (unsigned long)histogram->count, profiler_toUs(histogram->min),
+           profiler_toUs((double)histogram->sum / histogram->count),
+           profiler_toUs(profiler_percentile(histogram, PERCENTILE)),
+           profiler_toUs(histogram->max));
+  }
+  printf("frame overruns: %lu of %lu (period %.0f us)\n",
+         (unsigned long)overrunCount,
+         (unsigned long)histograms[profiler_frame].count,
+         profiler_toUs(periodTicks));
+}
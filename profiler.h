@@ -0,0 +1,38 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+// The parts of a frame that are timed separately. profiler_tick covers the
+// whole of gameLoop_tick, which only runs on some frames. profiler_frame
+// covers the whole of gameLoop_frame and is the one checked against the
+// period.
+typedef enum {
+  profiler_input,
+  profiler_asteroid,
+  profiler_laser,
+  profiler_spaceship,
+  profiler_game,
+  profiler_tick,
+  profiler_render,
+  profiler_present,
+  profiler_frame,
+  PROFILER_SECTION_COUNT
+} profiler_section_t;
+
+// Clear every histogram and the overrun count.
+void profiler_init();
+
+// Add one timing, in profilerClock ticks, to a section's histogram. Recording
+// profiler_frame also counts an overrun when the time is longer than
+// CONFIG_TIMER_PERIOD.
+void profiler_record(profiler_section_t section, uint32_t elapsed);
+
+// Number of frames that took longer than the timer period.
+uint32_t profiler_getOverrunCount();
+
+// Print count, min, mean, p99 and max for every section, in microseconds,
+// followed by the overrun count.
+void profiler_dump();
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,30 @@
+#include "profilerClock.h"
+#include "config.h"
+#include "interrupts.h"
+#include "xparameters.h"
+#include <stdint.h>
+
+// Same timer setup as main.c: the private timer runs at half the CPU clock and
+// counts down from the load value once per CONFIG_TIMER_PERIOD.
+#define TIMER_CLOCK_FREQUENCY (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+#define TIMER_LOAD_VALUE                                                       \
+  ((uint32_t)((CONFIG_TIMER_PERIOD * TIMER_CLOCK_FREQUENCY) - 1.0))
+#define TIMER_PERIOD_TICKS (TIMER_LOAD_VALUE + 1)
+
+// The counter restarts every period, so whole periods come from the ISR count
+// and the part of the current period from how far the counter has run down.
+// If the ISR count changes while the counter is read, the counter reloaded in
+// between, so read both again. A reload whose interrupt is still pending
+// reads as up to one period early; frames finish well inside a period, so this
+// only shows up for overruns.
+uint32_t profilerClock_now() {
+  uint32_t periods;
+  uint32_t counter;
+  do {
+    periods = interrupts_isrInvocationCount();
+    counter = interrupts_getPrivateTimerCounterValue();
+  } while (periods != interrupts_isrInvocationCount());
+  return periods * TIMER_PERIOD_TICKS + (TIMER_LOAD_VALUE - counter);
+}
+
+uint32_t profilerClock_ticksPerSecond() { return TIMER_CLOCK_FREQUENCY; }
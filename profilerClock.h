@@ -0,0 +1,17 @@
+#ifndef PROFILERCLOCK_H_
+#define PROFILERCLOCK_H_
+
+#include <stdint.h>
+
+// The time source for the tick profiler. The board reads the ARM private
+// timer; the host build supplies a monotonic clock instead (host/). Only
+// differences between two readings mean anything, and they stay correct
+// across the 32-bit wrap as long as the interval is shorter than one wrap.
+
+// Current time in clock ticks.
+uint32_t profilerClock_now();
+
+// Clock ticks per second.
+uint32_t profilerClock_ticksPerSecond();
+
+#endif /* PROFILERCLOCK_H_ */
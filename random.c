@@ -0,0 +1,95 @@
+#include "random.h"
+#include <stdint.h>
+
+#define GOLDEN_RATIO_32 0x9e3779b9u
+
+static inline uint32_t random_rotateLeft(uint32_t x, uint8_t k) {
+  return (x << k) | (x >> (32 - k));
+}
+
+// Bijective 32-bit mix (the MurmurHash3 finalizer), so distinct inputs give
+// distinct outputs.
+static uint32_t random_mix(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x85ebca6bu;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35u;
+  x ^= x >> 16;
+  return x;
+}
+
+// Each word comes from a different mix input, so at most one of them is 0
+// and the state can never be all zeros, which xoshiro cannot leave.
+void random_seed(random_t *random, uint32_t seed) {
+  for (uint8_t i = 0; i < 4; i++) {
+    random->state[i] = random_mix(seed + (i + 1) * GOLDEN_RATIO_32);
+  }
+}
+
+uint32_t random_deriveSeed(uint32_t seed, uint32_t key) {
+  return random_mix(random_mix(seed) ^ (key * GOLDEN_RATIO_32 + 1));
+}
+
+// xoshiro128** 1.1 (Blackman and Vigna): period 2^128 - 1, four words of
+// state, and only shifts, xors and two multiplies per number.
+static inline uint32_t random_step(uint32_t *s) {
+  uint32_t result = random_rotateLeft(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = random_rotateLeft(s[3], 11);
+  return result;
+}
+
+uint32_t random_next(random_t *random) { return random_step(random->state); }
+
+// Lemire's multiply-and-shift: the high word of next * bound is in
+// [0, bound). Low words below 2^32 mod bound would make some results more
+// likely, so those draws are thrown away; with the small bounds the game uses
+// that almost never happens.
+static inline uint32_t random_stepBelow(uint32_t *s, uint32_t bound) {
+  uint64_t m = (uint64_t)random_step(s) * bound;
+  if ((uint32_t)m < bound) {
+    uint32_t threshold = -bound % bound;
+    while ((uint32_t)m < threshold) {
+      m = (uint64_t)random_step(s) * bound;
+    }
+  }
+  return m >> 32;
+}
+
+uint32_t random_below(random_t *random, uint32_t bound) {
+  return random_stepBelow(random->state, bound);
+}
+
+// The state is copied into locals for the loop so it can stay in registers.
+void random_fillPositions(random_t *random, int16_t *x, int16_t *y,
+                          uint16_t count, uint16_t width, uint16_t height) {
+  uint32_t s[4] = {random->state[0], random->state[1], random->state[2],
+                   random->state[3]};
+  for (uint16_t i = 0; i < count; i++) {
+    x[i] = (int16_t)random_stepBelow(s, width);
+    y[i] = (int16_t)random_stepBelow(s, height);
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    random->state[i] = s[i];
+  }
+}
+
+// One draw per element: the low bit picks the sign and the rest the speed.
+void random_fillVelocities(random_t *random, int8_t *velocity, uint16_t count,
+                           uint8_t minSpeed, uint8_t speedRange) {
+  uint32_t s[4] = {random->state[0], random->state[1], random->state[2],
+                   random->state[3]};
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t draw = random_stepBelow(s, 2 * (uint32_t)speedRange);
+    int8_t speed = (int8_t)(minSpeed + (draw >> 1));
+    velocity[i] = draw & 1 ? -speed : speed;
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    random->state[i] = s[i];
+  }
+}
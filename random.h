@@ -0,0 +1,39 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <stdint.h>
+
+// Small, fast pseudo-random numbers (xoshiro128**) with the state held by the
+// caller, so every stream is reproducible and independent of libc's rand().
+// Derive a seed for each thing that needs its own stream, such as a level or
+// one event within it, from a parent seed with random_deriveSeed; the
+// numbers one stream gives out then do not depend on how many any other
+// stream has used.
+typedef struct {
+  uint32_t state[4];
+} random_t;
+
+// Start random on the stream for seed. Any seed, including 0, is fine.
+void random_seed(random_t *random, uint32_t seed);
+
+// Seed for child stream key of the stream seeded with seed. Different keys
+// give unrelated seeds.
+uint32_t random_deriveSeed(uint32_t seed, uint32_t key);
+
+// Next 32 random bits.
+uint32_t random_next(random_t *random);
+
+// Uniform in [0, bound). bound must not be 0.
+uint32_t random_below(random_t *random, uint32_t bound);
+
+// Fill x[i] and y[i] for i in [0, count) with points uniform over
+// [0, width) x [0, height).
+void random_fillPositions(random_t *random, int16_t *x, int16_t *y,
+                          uint16_t count, uint16_t width, uint16_t height);
+
+// Fill velocity[i] for i in [0, count) with a speed uniform in
+// [minSpeed, minSpeed + speedRange) and a random sign.
+void random_fillVelocities(random_t *random, int8_t *velocity, uint16_t count,
+                           uint8_t minSpeed, uint8_t speedRange);
+
+#endif /* RANDOM_H_ */
@@ -0,0 +1,458 @@
+#include "render.h"
+#include "display.h"
+#include "framebuffer.h"
+#include "text.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FOREGROUND_COLOR DISPLAY_WHITE
+#define BACKGROUND_COLOR DISPLAY_BLACK
+
+// Flushing one more rectangle costs some bus setup on top of its pixels, and
+// every rectangle is checked against every primitive, so two rectangles are
+// merged when the union is no bigger than the pair plus this many pixels.
+#define RECT_OVERHEAD_PIXELS 64
+
+typedef enum { circle_prim, fillCircle_prim, line_prim } primitiveType_t;
+
+// One submitted primitive. Circles keep their radius in x1.
+typedef struct {
+  primitiveType_t type;
+  int16_t x0;
+  int16_t y0;
+  int16_t x1;
+  int16_t y1;
+} primitive_t;
+
+typedef struct {
+  bool visible;
+  int16_t x;
+  int16_t y;
+  uint8_t size;
+  char str[RENDER_MAX_TEXT_LENGTH + 1];
+} textItem_t;
+
+// Inclusive on x0/y0 and exclusive on x1/y1.
+typedef struct {
+  int16_t x0;
+  int16_t y0;
+  int16_t x1;
+  int16_t y1;
+} rect_t;
+
+// Primitives from the frame being built and from the frame on screen.
+static primitive_t primitiveLists[2][RENDER_MAX_PRIMITIVES];
+static primitive_t *newPrimitives = primitiveLists[0];
+static primitive_t *oldPrimitives = primitiveLists[1];
+// Wider than a store index: the lists hold asteroids and lasers together.
+static uint32_t newCount;
+static uint32_t oldCount;
+
+static textItem_t texts[RENDER_MAX_TEXTS];
+static textItem_t shownTexts[RENDER_MAX_TEXTS];
+
+static rect_t dirtyRects[RENDER_MAX_DIRTY_RECTS];
+static uint16_t dirtyCount;
+
+static render_stats_t stats;
+
+// Clear the frame lists and counters.
+void render_init() {
+  newCount = 0;
+  oldCount = 0;
+  dirtyCount = 0;
+  memset(texts, 0, sizeof texts);
+  memset(shownTexts, 0, sizeof shownTexts);
+  memset(&stats, 0, sizeof stats);
+}
+
+static void render_addPrimitive(primitiveType_t type, int16_t x0, int16_t y0,
+                                int16_t x1, int16_t y1) {
+  if (newCount >= RENDER_MAX_PRIMITIVES) {
+    stats.droppedPrimitives++;
+    return;
+  }
+  newPrimitives[newCount++] =
+      (primitive_t){.type = type, .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1};
+}
+
+void render_circle(int16_t x, int16_t y, uint8_t radius) {
+  render_addPrimitive(circle_prim, x, y, radius, 0);
+}
+
+void render_fillCircle(int16_t x, int16_t y, uint8_t radius) {
+  render_addPrimitive(fillCircle_prim, x, y, radius, 0);
+}
+
+void render_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  render_addPrimitive(line_prim, x0, y0, x1, y1);
+}
+
+void render_setText(uint8_t slot, int16_t x, int16_t y, uint8_t size,
+                    const char *str) {
+  if (slot >= RENDER_MAX_TEXTS) {
+    return;
+  }
+  textItem_t *text = &texts[slot];
+  text->visible = true;
+  text->x = x;
+  text->y = y;
+  text->size = size;
+  strncpy(text->str, str, RENDER_MAX_TEXT_LENGTH);
+  text->str[RENDER_MAX_TEXT_LENGTH] = '\0';
+}
+
+void render_clearText(uint8_t slot) {
+  if (slot < RENDER_MAX_TEXTS) {
+    texts[slot].visible = false;
+  }
+}
+
+// Number of pixels the display's midpoint circle routine writes.
+static uint32_t render_circlePixels(int16_t radius) {
+  int16_t f = 1 - radius;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * radius;
+  int16_t x = 0;
+  int16_t y = radius;
+  uint32_t pixels = 4;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    pixels += 8;
+  }
+  return pixels;
+}
+
+// Number of pixels inside a filled circle.
+static uint32_t render_fillCirclePixels(int16_t radius) {
+  uint32_t pixels = 0;
+  int16_t x = radius;
+  for (int16_t y = 0; y <= radius; y++) {
+    while (x * x + y * y > radius * radius) {
+      x--;
+    }
+    pixels += (y == 0 ? 1 : 2) * (2 * x + 1);
+  }
+  return pixels;
+}
+
+static uint32_t render_primitivePixels(const primitive_t *prim) {
+  switch (prim->type) {
+  case circle_prim:
+    return render_circlePixels(prim->x1);
+  case fillCircle_prim:
+    return render_fillCirclePixels(prim->x1);
+  case line_prim: {
+    int16_t dx =
+        prim->x1 > prim->x0 ? prim->x1 - prim->x0 : prim->x0 - prim->x1;
+    int16_t dy =
+        prim->y1 > prim->y0 ? prim->y1 - prim->y0 : prim->y0 - prim->y1;
+    return (dx > dy ? dx : dy) + 1;
+  }
+  default:
+    return 0;
+  }
+}
+
+static void render_drawPrimitive(const primitive_t *prim, uint16_t color) {
+  switch (prim->type) {
+  case circle_prim:
+    framebuffer_drawCircle(prim->x0, prim->y0, prim->x1, color);
+    break;
+  case fillCircle_prim:
+    framebuffer_fillCircle(prim->x0, prim->y0, prim->x1, color);
+    break;
+  case line_prim:
+    framebuffer_drawLine(prim->x0, prim->y0, prim->x1, prim->y1, color);
+    break;
+  default:
+    break;
+  }
+}
+
+static bool render_primitivesEqual(const primitive_t *a, const primitive_t *b) {
+  return a->type == b->type && a->x0 == b->x0 && a->y0 == b->y0 &&
+         a->x1 == b->x1 && a->y1 == b->y1;
+}
+
+static rect_t render_primitiveBounds(const primitive_t *prim) {
+  if (prim->type == line_prim) {
+    return (rect_t){.x0 = prim->x0 < prim->x1 ? prim->x0 : prim->x1,
+                    .y0 = prim->y0 < prim->y1 ? prim->y0 : prim->y1,
+                    .x1 = (prim->x0 > prim->x1 ? prim->x0 : prim->x1) + 1,
+                    .y1 = (prim->y0 > prim->y1 ? prim->y0 : prim->y1) + 1};
+  }
+  return (rect_t){.x0 = prim->x0 - prim->x1,
+                  .y0 = prim->y0 - prim->x1,
+                  .x1 = prim->x0 + prim->x1 + 1,
+                  .y1 = prim->y0 + prim->x1 + 1};
+}
+
+static rect_t render_textBounds(const textItem_t *text) {
+  int16_t length = strlen(text->str);
+  return (rect_t){.x0 = text->x,
+                  .y0 = text->y,
+                  .x1 = text->x + length * DISPLAY_CHAR_WIDTH * text->size,
+                  .y1 = text->y + DISPLAY_CHAR_HEIGHT * text->size};
+}
+
+// Bounds of the index'th character cell of a text item.
+static rect_t render_textCellBounds(const textItem_t *text, uint8_t index) {
+  int16_t width = DISPLAY_CHAR_WIDTH * text->size;
+  int16_t x0 = text->x + index * width;
+  return (rect_t){.x0 = x0,
+                  .y0 = text->y,
+                  .x1 = x0 + width,
+                  .y1 = text->y + DISPLAY_CHAR_HEIGHT * text->size};
+}
+
+static int32_t render_rectArea(rect_t rect) {
+  return (int32_t)(rect.x1 - rect.x0) * (rect.y1 - rect.y0);
+}
+
+static rect_t render_rectUnion(rect_t a, rect_t b) {
+  return (rect_t){.x0 = a.x0 < b.x0 ? a.x0 : b.x0,
+                  .y0 = a.y0 < b.y0 ? a.y0 : b.y0,
+                  .x1 = a.x1 > b.x1 ? a.x1 : b.x1,
+                  .y1 = a.y1 > b.y1 ? a.y1 : b.y1};
+}
+
+static bool render_rectsOverlap(rect_t a, rect_t b) {
+  return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+}
+
+// Add a rectangle to the dirty set, merging it with any rectangle where that
+// does not cost more pixels than painting both. Merging can make the result
+// worth merging with another, so keep going until nothing changes.
+static void render_addDirtyRect(rect_t rect) {
+  // Only the screen can be painted.
+  rect.x0 = rect.x0 < 0 ? 0 : rect.x0;
+  rect.y0 = rect.y0 < 0 ? 0 : rect.y0;
+  rect.x1 = rect.x1 > DISPLAY_WIDTH ? DISPLAY_WIDTH : rect.x1;
+  rect.y1 = rect.y1 > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : rect.y1;
+  if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1) {
+    return;
+  }
+
+  uint16_t i = 0;
+  while (i < dirtyCount) {
+    rect_t merged = render_rectUnion(dirtyRects[i], rect);
+    if (render_rectArea(merged) <= render_rectArea(dirtyRects[i]) +
+                                       render_rectArea(rect) +
+                                       RECT_OVERHEAD_PIXELS) {
+      dirtyRects[i] = dirtyRects[--dirtyCount];
+      rect = merged;
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+
+  if (dirtyCount == RENDER_MAX_DIRTY_RECTS) {
+    // Out of room: fold into the rectangle that grows the least.
+    uint16_t best = 0;
+    int32_t bestGrowth = INT32_MAX;
+    for (i = 0; i < dirtyCount; i++) {
+      int32_t growth = render_rectArea(render_rectUnion(dirtyRects[i], rect)) -
+                       render_rectArea(dirtyRects[i]);
+      if (growth < bestGrowth) {
+        bestGrowth = growth;
+        best = i;
+      }
+    }
+    rect = render_rectUnion(dirtyRects[best], rect);
+    dirtyRects[best] = dirtyRects[--dirtyCount];
+    render_addDirtyRect(rect);
+    return;
+  }
+  dirtyRects[dirtyCount++] = rect;
+}
+
+static bool render_isDirty(rect_t bounds) {
+  for (uint16_t i = 0; i < dirtyCount; i++) {
+    if (render_rectsOverlap(dirtyRects[i], bounds)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool render_textChanged(const textItem_t *a, const textItem_t *b) {
+  if (a->visible != b->visible) {
+    return true;
+  }
+  return a->visible && (a->x != b->x || a->y != b->y || a->size != b->size ||
+                        strcmp(a->str, b->str) != 0);
+}
+
+// True unless the text is shown in both frames at the same place and size.
+static bool render_textMovedOrHidden(const textItem_t *a,
+                                     const textItem_t *b) {
+  return !a->visible || !b->visible || a->x != b->x || a->y != b->y ||
+         a->size != b->size;
+}
+
+// Number of pixels framebuffer_drawChar writes for c at size.
+static uint32_t render_charPixels(char c, uint8_t size) {
+  const text_glyph_t *glyph = text_getGlyph(c, size);
+  uint32_t pixels = 0;
+  for (uint8_t row = 0; row < FONT_GLYPH_ROWS; row++) {
+    pixels += __builtin_popcount(glyph->rows[row]);
+  }
+  return pixels * size;
+}
+
+// Draw the index'th character of a text item and return its pixel count.
+static uint32_t render_drawCell(const textItem_t *text, uint8_t index,
+                                uint16_t color) {
+  rect_t cell = render_textCellBounds(text, index);
+  framebuffer_drawChar(cell.x0, cell.y0, text->size, text->str[index], color);
+  return render_charPixels(text->str[index], text->size);
+}
+
+// Text that stayed in the same place at the same size only needs the cells
+// whose character changed, including cells past the end of the shorter
+// string. A score going from 1200 to 1300 dirties one cell. The old
+// characters are erased; returns how many pixels that wrote.
+static uint32_t render_eraseChangedCells(const textItem_t *old,
+                                         const textItem_t *new) {
+  uint32_t pixels = 0;
+  uint8_t oldLength = strlen(old->str);
+  uint8_t newLength = strlen(new->str);
+  uint8_t longest = oldLength > newLength ? oldLength : newLength;
+  for (uint8_t i = 0; i < longest; i++) {
+    if (i >= oldLength || i >= newLength || old->str[i] != new->str[i]) {
+      if (i < oldLength) {
+        pixels += render_drawCell(old, i, BACKGROUND_COLOR);
+      }
+      render_addDirtyRect(render_textCellBounds(new, i));
+    }
+  }
+  return pixels;
+}
+
+// Erase every character of a text item and return how many pixels that
+// wrote.
+static uint32_t render_eraseText(const textItem_t *text) {
+  uint32_t pixels = 0;
+  for (uint8_t i = 0; text->str[i] != '\0'; i++) {
+    pixels += render_drawCell(text, i, BACKGROUND_COLOR);
+  }
+  return pixels;
+}
+
+// Draw the cells of a text item that overlap the dirty rectangles and return
+// how many pixels that wrote.
+static uint32_t render_drawText(const textItem_t *text) {
+  uint32_t pixels = 0;
+  for (uint8_t i = 0; text->str[i] != '\0'; i++) {
+    if (render_isDirty(render_textCellBounds(text, i))) {
+      pixels += render_drawCell(text, i, FOREGROUND_COLOR);
+    }
+  }
+  return pixels;
+}
+
+// Work out what changed since the last frame, erase it by drawing the old
+// primitives and characters in the background color, and redraw whatever
+// overlaps the dirty rectangles into the framebuffer. Erasing only touches
+// the old shapes' own pixels, and any shape those pixels belonged to overlaps
+// a dirty rectangle, so it is drawn again whole. Only the dirty rectangles
+// are marked for framebuffer_present.
+void render_drawFrame() {
+  dirtyCount = 0;
+  stats.framePixels = 0;
+  stats.frameLegacyPixels = 0;
+
+  // Subsystems submit in the same order every frame, so a primitive that has
+  // not changed is usually at the same position in both lists. Anything else
+  // is treated as erased from its old place and drawn at its new one.
+  uint32_t longest = newCount > oldCount ? newCount : oldCount;
+  for (uint32_t i = 0; i < longest; i++) {
+    bool hasOld = i < oldCount;
+    bool hasNew = i < newCount;
+    // The old approach erased every object and drew it again every frame.
+    if (hasOld) {
+      stats.frameLegacyPixels += render_primitivePixels(&oldPrimitives[i]);
+    }
+    if (hasNew) {
+      stats.frameLegacyPixels += render_primitivePixels(&newPrimitives[i]);
+    }
+    if (hasOld && hasNew &&
+        render_primitivesEqual(&oldPrimitives[i], &newPrimitives[i])) {
+      continue;
+    }
+    if (hasOld) {
+      render_drawPrimitive(&oldPrimitives[i], BACKGROUND_COLOR);
+      stats.framePixels += render_primitivePixels(&oldPrimitives[i]);
+      render_addDirtyRect(render_primitiveBounds(&oldPrimitives[i]));
+    }
+    if (hasNew) {
+      render_addDirtyRect(render_primitiveBounds(&newPrimitives[i]));
+    }
+  }
+  for (uint8_t i = 0; i < RENDER_MAX_TEXTS; i++) {
+    if (!render_textChanged(&texts[i], &shownTexts[i])) {
+      continue;
+    }
+    if (!render_textMovedOrHidden(&texts[i], &shownTexts[i])) {
+      stats.framePixels += render_eraseChangedCells(&shownTexts[i], &texts[i]);
+      stats.frameLegacyPixels +=
+          render_rectArea(render_textBounds(&shownTexts[i])) +
+          render_rectArea(render_textBounds(&texts[i]));
+      continue;
+    }
+    if (shownTexts[i].visible) {
+      rect_t bounds = render_textBounds(&shownTexts[i]);
+      stats.framePixels += render_eraseText(&shownTexts[i]);
+      render_addDirtyRect(bounds);
+      stats.frameLegacyPixels += render_rectArea(bounds);
+    }
+    if (texts[i].visible) {
+      rect_t bounds = render_textBounds(&texts[i]);
+      render_addDirtyRect(bounds);
+      stats.frameLegacyPixels += render_rectArea(bounds);
+    }
+  }
+
+  for (uint16_t i = 0; i < dirtyCount; i++) {
+    rect_t rect = dirtyRects[i];
+    framebuffer_markDirty(rect.x0, rect.y0, rect.x1 - rect.x0,
+                          rect.y1 - rect.y0);
+  }
+  if (dirtyCount != 0) {
+    for (uint32_t i = 0; i < newCount; i++) {
+      if (render_isDirty(render_primitiveBounds(&newPrimitives[i]))) {
+        render_drawPrimitive(&newPrimitives[i], FOREGROUND_COLOR);
+        stats.framePixels += render_primitivePixels(&newPrimitives[i]);
+      }
+    }
+    for (uint8_t i = 0; i < RENDER_MAX_TEXTS; i++) {
+      if (texts[i].visible && render_isDirty(render_textBounds(&texts[i]))) {
+        stats.framePixels += render_drawText(&texts[i]);
+      }
+    }
+  }
+
+  stats.frameDirtyRects = dirtyCount;
+  stats.totalPixels += stats.framePixels;
+  stats.totalLegacyPixels += stats.frameLegacyPixels;
+
+  // What was just drawn becomes the frame on screen.
+  primitive_t *swap = oldPrimitives;
+  oldPrimitives = newPrimitives;
+  newPrimitives = swap;
+  oldCount = newCount;
+  newCount = 0;
+  memcpy(shownTexts, texts, sizeof texts);
+}
+
+render_stats_t render_getStats() { return stats; }
@@ -0,0 +1,72 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include "asteroid.h"
+#include "laser.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Most primitives (circles and lines) the render stage can hold in one frame.
+// Anything submitted past this is dropped and counted in droppedPrimitives.
+#ifndef RENDER_MAX_PRIMITIVES
+#define RENDER_MAX_PRIMITIVES (MAX_ASTEROID_COUNT + MAX_LASER_COUNT + 48)
+#endif
+
+// Number of independent text items (see render_setText) and the longest
+// string each can hold, not counting the terminator.
+#define RENDER_MAX_TEXTS 8
+#define RENDER_MAX_TEXT_LENGTH 20
+
+// Interpolation weights are fractions of RENDER_ALPHA_ONE: 0 is the previous
+// tick and RENDER_ALPHA_ONE is the current one.
+#define RENDER_ALPHA_ONE 256
+
+// Upper limit on dirty rectangles per frame. Past this, new rectangles are
+// merged into whichever existing one grows the least.
+#define RENDER_MAX_DIRTY_RECTS 32
+
+// Pixel counts for comparing the dirty-rectangle pass against erasing and
+// redrawing every object. These are writes into the framebuffer; see
+// framebuffer_getStats for what reaches the display. The legacy figure is
+// what the old per-object approach would have written for the same frames.
+typedef struct {
+  uint16_t frameDirtyRects;
+  uint32_t framePixels;
+  uint32_t frameLegacyPixels;
+  uint64_t totalPixels;
+  uint64_t totalLegacyPixels;
+  uint32_t droppedPrimitives;
+} render_stats_t;
+
+// Clear the frame lists and counters. Call once before the first frame.
+void render_init();
+
+// The point alpha of the way from the previous tick's position to the
+// current one, for drawing frames that fall between ticks.
+static inline int16_t render_lerp(int16_t previous, int16_t current,
+                                  uint16_t alpha) {
+  return previous + (int16_t)((current - previous) * alpha / RENDER_ALPHA_ONE);
+}
+
+// Submit one primitive for this frame. Subsystems submit everything they want
+// on screen every frame; anything not submitted again is erased automatically.
+void render_circle(int16_t x, int16_t y, uint8_t radius);
+void render_fillCircle(int16_t x, int16_t y, uint8_t radius);
+void render_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+
+// Text is retained instead: an item stays on screen until it is changed or
+// cleared. slot is any number below RENDER_MAX_TEXTS chosen by the caller.
+void render_setText(uint8_t slot, int16_t x, int16_t y, uint8_t size,
+                    const char *str);
+void render_clearText(uint8_t slot);
+
+// Work out what changed since the last frame, erase the old shapes, merge
+// what changed into dirty rectangles and redraw what overlaps them in the
+// framebuffer.
+// Call once per frame after every subsystem has submitted, then call
+// framebuffer_present to put the result on the display.
+void render_drawFrame();
+
+render_stats_t render_getStats();
+
+#endif /* RENDER_H_ */
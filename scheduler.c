@@ -0,0 +1,102 @@
+#include "scheduler.h"
+#include "profilerClock.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define US_PER_SECOND 1000000
+
+typedef struct {
+  scheduler_job_t job;
+  uint32_t deadline; // Tick count the job must run before.
+  uint32_t cost;     // Estimated run time in profilerClock ticks.
+} entry_t;
+
+// Queued jobs, kept sorted by deadline so the next one is always at index 0.
+// The queue is small, so insertion sort beats anything cleverer.
+static entry_t queue[SCHEDULER_MAX_JOBS];
+static uint8_t queueCount;
+static uint32_t currentTick;
+static uint32_t droppedCount;
+
+// Empty the queue and restart the tick count.
+void scheduler_init() {
+  queueCount = 0;
+  currentTick = 0;
+  droppedCount = 0;
+}
+
+// Note that a game tick has started.
+void scheduler_advanceTick() { currentTick++; }
+
+// Deadlines are compared as a signed difference so they survive the tick
+// count wrapping.
+static bool scheduler_before(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+// Take the entry at index out of the queue, closing the gap.
+static void scheduler_remove(uint8_t index) {
+  for (uint8_t i = index; i + 1 < queueCount; i++) {
+    queue[i] = queue[i + 1];
+  }
+  queueCount--;
+}
+
+// Put an entry into the queue in deadline order, after any entry with the
+// same deadline so equal deadlines run in the order they were posted.
+static void scheduler_insert(entry_t entry) {
+  uint8_t i = queueCount;
+  while (i > 0 && scheduler_before(entry.deadline, queue[i - 1].deadline)) {
+    queue[i] = queue[i - 1];
+    i--;
+  }
+  queue[i] = entry;
+  queueCount++;
+}
+
+// Queue job to run within the next ticksFromNow ticks.
+bool scheduler_post(scheduler_job_t job, uint32_t ticksFromNow,
+                    uint32_t costUs) {
+  entry_t entry = {
+      .job = job,
+      .deadline = currentTick + ticksFromNow,
+      .cost = (uint32_t)((uint64_t)costUs * profilerClock_ticksPerSecond() /
+                         US_PER_SECOND)};
+  for (uint8_t i = 0; i < queueCount; i++) {
+    if (queue[i].job == job) {
+      if (!scheduler_before(entry.deadline, queue[i].deadline)) {
+        return true;
+      }
+      scheduler_remove(i);
+      break;
+    }
+  }
+  if (queueCount == SCHEDULER_MAX_JOBS) {
+    droppedCount++;
+    return false;
+  }
+  scheduler_insert(entry);
+  return true;
+}
+
+// Run queued jobs while they fit in budget. A job may post more jobs, so the
+// queue is re-read after every run.
+bool scheduler_runIdle(uint32_t budget) {
+  uint32_t start = profilerClock_now();
+  while (queueCount != 0) {
+    entry_t next = queue[0];
+    bool due = !scheduler_before(currentTick + 1, next.deadline);
+    uint32_t used = profilerClock_now() - start;
+    if (!due && (used > budget || next.cost > budget - used)) {
+      break;
+    }
+    scheduler_remove(0);
+    next.job();
+  }
+  return queueCount != 0;
+}
+
+// True if no job is queued.
+bool scheduler_isIdle() { return queueCount == 0; }
+
+uint32_t scheduler_getDroppedCount() { return droppedCount; }
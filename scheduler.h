@@ -0,0 +1,42 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Deferrable work that runs in the slack after each frame instead of inside
+// a tick: log draining, HUD redraws and the like. Jobs run earliest deadline
+// first, and only while they fit in the time left before the next frame,
+// except that a job due before the next tick always runs.
+
+// Most jobs that can be queued at once.
+#define SCHEDULER_MAX_JOBS 8
+
+typedef void (*scheduler_job_t)();
+
+// Empty the queue and restart the tick count.
+void scheduler_init();
+
+// Note that a game tick has started. Deadlines are counted in these ticks.
+void scheduler_advanceTick();
+
+// Queue job to run within the next ticksFromNow ticks; 1 means before the
+// next tick starts. costUs is an estimate of its run time, used to decide
+// whether it fits in the slack. A job that is already queued is not added
+// again, but its deadline moves earlier if the new one is sooner. Returns
+// false if the queue is full.
+bool scheduler_post(scheduler_job_t job, uint32_t ticksFromNow,
+                    uint32_t costUs);
+
+// Run queued jobs, soonest deadline first, while they fit in budget
+// (profilerClock ticks until the next frame). Jobs that are due run even
+// if they do not fit. Returns true if jobs are still queued.
+bool scheduler_runIdle(uint32_t budget);
+
+// True if no job is queued.
+bool scheduler_isIdle();
+
+// Number of posts that were refused because the queue was full.
+uint32_t scheduler_getDroppedCount();
+
+#endif /* SCHEDULER_H_ */
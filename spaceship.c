@@ -1,28 +1,31 @@
 #include "spaceship.h"
-#include "buttons.h"
+#include "config.h"
 #include "display.h"
+#include "framebuffer.h"
+#include "input.h"
 #include "laser.h"
 #include "linearAlg.h"
+#include "logger.h"
+#include "render.h"
+#include "stateHash.h"
 #include "utils.h"
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <string.h>
 
-#define SPACESHIP_COLOR DISPLAY_WHITE
-#define ERASE_COLOR DISPLAY_BLACK
-#define DRAW_VALUE true
-#define ERASE_VALUE false
 
 #define DELAY_TIME_MS 50 // Wait 50ms.
 
-#define LASER_COUNTER_MAX 4
+// Shortest time between shots in seconds, and the same time in ticks.
+#define LASER_COOLDOWN 0.4
+#define LASER_COUNTER_MAX                                                      \
+  ((uint8_t)(LASER_COOLDOWN / CONFIG_TICK_PERIOD + 0.5))
 
 // Definitions for buttons.
-#define LEFT_BTN0_MASK 0x1
-#define THRUST_BTN1_MASK 0x2
-#define RIGHT_BTN2_MASK 0x4
-#define FIRE_BTN3_MASK 0x8
+#define LEFT_BTN0_MASK INPUT_BTN0
+#define THRUST_BTN1_MASK INPUT_BTN1
+#define RIGHT_BTN2_MASK INPUT_BTN2
+#define FIRE_BTN3_MASK INPUT_BTN3
 
 // Definitions for rotation.
 #define PI 3.14159265358979323846
@@ -40,24 +43,37 @@
 #define ROTATE_CCW true
 #define ROTATE_CW false
 
-// Definitions for translational movement.
+// Rotation only ever moves in ROTATION_ANGLE_CHANGE_DEG steps, so the ship has
+// this many possible headings (360 / 15). Heading 0 is the starting shape and
+// each step up turns it one step clockwise.
+#define HEADING_COUNT 24
+
+// Definitions for translational movement. The velocity vector is kept in
+// units per tick, so these are converted from per-second figures.
+#define THRUST_ACCELERATION                                                    \
+  100.0 // Units per second squared the rockets add to the velocity.
+
+#define MAX_SPEED                                                              \
+  300.0 // Top speed in units per second. This acts as a drag
+        // coefficient of sorts where the drag equation is Cd *
+        // (V^2) / 2. The MAX_SPEED definition combines the
+        // values of 1 / 2 and Cd into a single value.
+
 #define ACCELERATION                                                           \
-  1.0 // Number of units to add to the velocity vector each
-      // tick.
+  CONFIG_PER_TICK(CONFIG_PER_TICK(                                             \
+      THRUST_ACCELERATION)) // Number of units to add to the velocity vector
+                            // each tick.
 
 #define MAX_VELOCITY                                                           \
-  30.0 // This is the maximum amplitude of the velocity vector.
-       // This is also the maximum number of units the spaceship
-       // will travel each tick. This number acts as a drag
-       // coefficient of sorts where the drag equation is Cd *
-       // (V^2) / 2. The MAX_VELOCITY definition combines the
-       // values of 1 / 2 and Cd into a single value.
+  CONFIG_PER_TICK(MAX_SPEED) // This is the maximum amplitude of the velocity
+                             // vector. This is also the maximum number of
+                             // units the spaceship will travel each tick.
 
+// Find the magnitude of the drag by finding the velocity (which can vary)
+// squared divided by the maximum velocity.
 #define DRAG_MAGNITUDE(velocity)                                               \
-  ((velocity * velocity) /                                                     \
-   MAX_VELOCITY) // Find the magnitude of the drag by finding the
-                 // velocity (which can vary) squared divided by the
-                 // maximum velocity.
+  LINEARALG_DIV(LINEARALG_MUL(velocity, velocity),                             \
+                LINEARALG_FROM_DOUBLE(MAX_VELOCITY))
 
 // Definitions for screen wrap.
 #define SCREEN_WIDTH (display_width())
@@ -100,10 +116,10 @@ typedef struct {
                           // that compose the lines of the spaceship. This is
                           // also used to calculate the movement of the ship.
   uint8_t numVerticies;   // Length of vectorArr.
-  vector2D_t vectorArr[NUM_VERTICIES]; // Hold the positions of the spaceship's
-                                       // vectors relative to the center point.
-  elementSize_t directVectMag;         // Holds the magnitude of the direction
-                                       // vector which will not change.
+  uint8_t heading;        // Index into the orientation tables.
+  const vector2D_t *vectorArr; // The positions of the spaceship's vectors
+                               // relative to the center point: the row of
+                               // orientationVertices for heading.
   vector2D_t thrustVect; // Holds the x, y, coordinates of the to be added to
                          // the velocity vector when the spaceship has its
                          // "rockets" on.
@@ -112,77 +128,91 @@ typedef struct {
                                // constant value that will be initialized.
   vector2D_t
       velocityVect; // This holds the information for the velocity vector.
+  vector2D_t centerDelta; // How far the center point travelled last tick,
+                          // not counting the jump of a screen wrap.
+  vector2D_t previousCenter; // Where the center point was before the last
+                             // tick, for drawing frames between ticks. An
+                             // axis that wrapped holds the new position.
 } spaceship_t;
 
 // Function Declarations.
-void drawShip(bool draw);
+void drawShip(uint16_t alpha);
 void rotateShip(bool rotateCCW);
 void translateShip(bool moveForward);
 void fireLaser(bool fire);
+static void buildOrientationTables();
 
 // Declare a spaceship_t variable.
 spaceship_t spaceship;
 
-// Declare matrix variables to hold the values of the rotation matricies in the
-// counter clock-wise (CCW) and clock-wise (CW) directions.
-matrix2x2_t rotationCCW;
-matrix2x2_t rotationCW;
+// The ship's vertices and the unit vector it faces for every heading. They are
+// built from the starting shape in spaceship_init, so turning is an index
+// change and the shape never accumulates rounding error.
+static vector2D_t orientationVertices[HEADING_COUNT][NUM_VERTICIES];
+static vector2D_t orientationDirection[HEADING_COUNT];
 
 // Other Variables.
 static bool enabled;
+static uint8_t laserCooldown; // Ticks since the last shot, 0 when ready.
+
+// Fill orientationVertices and orientationDirection by rotating the starting
+// shape to each heading. Each heading is rotated directly from the starting
+// shape rather than from the previous heading, so no error carries over. The
+// rotation matrix is of the form:
+// [cos(theta), -sin(theta)
+//  sin(theta),  cos(theta)]
+// Because the coordinate system of the display is a left-handed coordinate
+// system a rotation of a positive angle will be in the CW direction.
+static void buildOrientationTables() {
+  const vector2D_t shape[NUM_VERTICIES] = {
+      {.x = LINEARALG_FROM_DOUBLE(VERTEX_1_X),
+       .y = LINEARALG_FROM_DOUBLE(VERTEX_1_Y)},
+      {.x = LINEARALG_FROM_DOUBLE(VERTEX_2_X),
+       .y = LINEARALG_FROM_DOUBLE(VERTEX_2_Y)},
+      {.x = LINEARALG_FROM_DOUBLE(VERTEX_3_X),
+       .y = LINEARALG_FROM_DOUBLE(VERTEX_3_Y)},
+      {.x = LINEARALG_FROM_DOUBLE(VERTEX_4_X),
+       .y = LINEARALG_FROM_DOUBLE(VERTEX_4_Y)},
+      {.x = LINEARALG_FROM_DOUBLE(VERTEX_5_X),
+       .y = LINEARALG_FROM_DOUBLE(VERTEX_5_Y)}};
+  for (uint8_t heading = 0; heading < HEADING_COUNT; heading++) {
+    double angle = heading * ROTATION_ANGLE_CHANGE_RAD;
+    matrix2x2_t rotation = {.vect1 = {.x = LINEARALG_FROM_DOUBLE(cos(angle)),
+                                      .y = LINEARALG_FROM_DOUBLE(sin(angle))},
+                            .vect2 = {.x = LINEARALG_FROM_DOUBLE(-sin(angle)),
+                                      .y = LINEARALG_FROM_DOUBLE(cos(angle))}};
+    linearAlg_transformArray(rotation, shape, orientationVertices[heading],
+                             NUM_VERTICIES);
+    // The ship faces along its first vertex.
+    orientationDirection[heading] = orientationVertices[heading][FIRST_INDEX];
+  }
+  linearAlg_normalizeArray(orientationDirection, orientationDirection,
+                           HEADING_COUNT);
+}
 
-// Initialize the spaceship with starting values. Create the rotation matricies
-// for CCW and CW rotation.
+// Initialize the spaceship with starting values.
 void spaceship_init() {
+  currentState = init_st;
   // Initialize the center point vector.
-  spaceship.centerPoint.x = CENTER_X;
-  spaceship.centerPoint.y = CENTER_Y;
+  spaceship.centerPoint.x = LINEARALG_FROM_INT(CENTER_X);
+  spaceship.centerPoint.y = LINEARALG_FROM_INT(CENTER_Y);
 
   // The number of points comprising the spaceship.
   spaceship.numVerticies = NUM_VERTICIES;
 
-  // Assign all of vectorArr to constant pre-defined values. Store the values in
-  // a fixed point format (i.e. scale them all by SCALING_FACTOR).
-  memcpy(spaceship.vectorArr,
-         (const vector2D_t[]){(vector2D_t){.x = VERTEX_1_X, .y = VERTEX_1_Y},
-                              (vector2D_t){.x = VERTEX_2_X, .y = VERTEX_2_Y},
-                              (vector2D_t){.x = VERTEX_3_X, .y = VERTEX_3_Y},
-                              (vector2D_t){.x = VERTEX_4_X, .y = VERTEX_4_Y},
-                              (vector2D_t){.x = VERTEX_5_X, .y = VERTEX_5_Y}},
-         sizeof spaceship.vectorArr);
-
-  // Initialize the thrust vector using the direction of the first vector in
-  // spaceship.vectorArr.
-  spaceship.directVectMag = linearAlg_calcMag(spaceship.vectorArr[FIRST_INDEX]);
-  spaceship.thrustVect = linearAlg_normVect(spaceship.vectorArr[FIRST_INDEX],
-                                            spaceship.directVectMag);
+  // Build the orientation tables, then start facing the way the shape is
+  // drawn.
+  buildOrientationTables();
+  spaceship.heading = 0;
+  spaceship.vectorArr = orientationVertices[spaceship.heading];
 
-  spaceship.thrustVectMag = ACCELERATION;
+  spaceship.thrustVectMag = LINEARALG_FROM_DOUBLE(ACCELERATION);
+  spaceship.thrustVect = (vector2D_t){.x = 0, .y = 0};
 
   // Initialize the velocity vector. Starting x, y values should be 0.
   spaceship.velocityVect = (vector2D_t){.x = 0, .y = 0};
-
-  // Assign the rotation matricies with appropriate
-  // values. The matrix that rotates vectors when
-  // multiplied is of the form:
-  // [cos(theta), -sin(theta)
-  //  sin(theta),  cos(theta)]
-  // This matrix can be thought of an array of 2 vectors
-  // with the first having elements of the first column
-  // of the matrix and the second vector having elements
-  // of the second column. Because the coordinate system
-  // of the display is a left-handed coordinate system a
-  // rotation of a positive angle will be in the CW
-  // direction.
-  rotationCCW.vect1.x = (elementSize_t)(cos(-ROTATION_ANGLE_CHANGE_RAD));
-  rotationCCW.vect1.y = (elementSize_t)(sin(-ROTATION_ANGLE_CHANGE_RAD));
-  rotationCCW.vect2.x = (elementSize_t)(-sin(-ROTATION_ANGLE_CHANGE_RAD));
-  rotationCCW.vect2.y = (elementSize_t)(cos(-ROTATION_ANGLE_CHANGE_RAD));
-
-  rotationCW.vect1.x = (elementSize_t)(cos(ROTATION_ANGLE_CHANGE_RAD));
-  rotationCW.vect1.y = (elementSize_t)(sin(ROTATION_ANGLE_CHANGE_RAD));
-  rotationCW.vect2.x = (elementSize_t)(-sin(ROTATION_ANGLE_CHANGE_RAD));
-  rotationCW.vect2.y = (elementSize_t)(cos(ROTATION_ANGLE_CHANGE_RAD));
+  spaceship.centerDelta = (vector2D_t){.x = 0, .y = 0};
+  spaceship.previousCenter = spaceship.centerPoint;
 }
 
 // Use this function to test various parts of the spaceship code.
@@ -197,15 +227,14 @@ void spaceship_runTest(bool rotateCCW, bool fireRockets) {
   // Repeatedly perform the rotation to test its functionality.
   // for (uint8_t i = 0; i < 5; i++) {
   while (true) {
-    // Draw the spaceship
-    drawShip(DRAW_VALUE);
+    // Draw the spaceship. The render stage erases the previous one.
+    drawShip(RENDER_ALPHA_ONE);
+    render_drawFrame();
+    framebuffer_present();
 
     // Wait a prescribed amount of time.
     utils_msDelay(DELAY_TIME_MS);
 
-    // Erase the previously drawn spaceship.
-    drawShip(ERASE_VALUE);
-
     // Rotate the spaceship CCW.
     rotateShip(rotateCCW);
 
@@ -214,44 +243,43 @@ void spaceship_runTest(bool rotateCCW, bool fireRockets) {
   }
 }
 
-// Draw the spaceship if the parameter draw is true. Otherwise erase the ship.
-void drawShip(bool draw) {
+// Submit the lines of the spaceship to this frame's render list, with the
+// center point alpha of the way through the last tick's move. The ship is
+// erased by the render stage when it is no longer drawn.
+void drawShip(uint16_t alpha) {
+  vector2D_t center = {
+      .x = spaceship.previousCenter.x +
+           (spaceship.centerPoint.x - spaceship.previousCenter.x) * alpha /
+               RENDER_ALPHA_ONE,
+      .y = spaceship.previousCenter.y +
+           (spaceship.centerPoint.y - spaceship.previousCenter.y) * alpha /
+               RENDER_ALPHA_ONE};
   // Loop through the spaceship.vectorArr to get the points for the lines that
   // make up the body of the ship. This will result in a closed path.
   for (uint8_t i = 0; i < spaceship.numVerticies; i++) {
     // Use the vertex at index i and the the one at vertex i + 1 to draw the
-    // lines as long as i + 1 is within the size of vectorArr.
-    if (i < spaceship.numVerticies - 1) {
-      display_drawLine((spaceship.centerPoint.x + spaceship.vectorArr[i].x),
-                       (spaceship.centerPoint.y + spaceship.vectorArr[i].y),
-                       (spaceship.centerPoint.x + spaceship.vectorArr[i + 1].x),
-                       (spaceship.centerPoint.y + spaceship.vectorArr[i + 1].y),
-                       draw ? SPACESHIP_COLOR : ERASE_COLOR);
-    } else { // Use the 1st index as the second x, y pair for the line if i + 1
-             // is equal to spaceship.numVerticies.
-      display_drawLine((spaceship.centerPoint.x + spaceship.vectorArr[i].x),
-                       (spaceship.centerPoint.y + spaceship.vectorArr[i].y),
-                       (spaceship.centerPoint.x + spaceship.vectorArr[0].x),
-                       (spaceship.centerPoint.y + spaceship.vectorArr[0].y),
-                       draw ? SPACESHIP_COLOR : ERASE_COLOR);
-    }
+    // lines. Use the 1st index as the second x, y pair for the line if i + 1
+    // is equal to spaceship.numVerticies.
+    uint8_t next = (i < spaceship.numVerticies - 1) ? i + 1 : 0;
+    render_line(LINEARALG_TO_INT(center.x + spaceship.vectorArr[i].x),
+                LINEARALG_TO_INT(center.y + spaceship.vectorArr[i].y),
+                LINEARALG_TO_INT(center.x + spaceship.vectorArr[next].x),
+                LINEARALG_TO_INT(center.y + spaceship.vectorArr[next].y));
   }
 }
 
 // Function to rotate the spaceship. If rotateCCW is true then the spaceship
-// will rotate counter-clockwise. Otherwise it will rotate clockwise.
+// will rotate counter-clockwise. Otherwise it will rotate clockwise. Each call
+// turns one heading step.
 void rotateShip(bool rotateCCW) {
-  // If rotateCCW is true, left multiply the vectors in the vectorArr of
-  // spaceship by the rotationCCW matrix.
   if (rotateCCW) {
-    for (uint8_t i = 0; i < spaceship.numVerticies; i++) {
-      linearAlg_matVectMultAx2D(rotationCCW, &(spaceship.vectorArr[i]));
-    }
-  } else { // Otherwise multiply by the rotationCW matrix.
-    for (uint8_t i = 0; i < spaceship.numVerticies; i++) {
-      linearAlg_matVectMultAx2D(rotationCW, &(spaceship.vectorArr[i]));
-    }
+    spaceship.heading =
+        (spaceship.heading == 0) ? HEADING_COUNT - 1 : spaceship.heading - 1;
+  } else {
+    spaceship.heading =
+        (spaceship.heading == HEADING_COUNT - 1) ? 0 : spaceship.heading + 1;
   }
+  spaceship.vectorArr = orientationVertices[spaceship.heading];
 }
 
 // Function to move the spaceship forward in the direction it is facing if the
@@ -272,19 +300,17 @@ void translateShip(bool moveForward) {
 
   // Next, invert the sign of both the x and y components of the vectors and
   // multiply them by the magnitude of the drag.
-  dragVect.x = -dragVect.x * dragVectMag;
-  dragVect.y = -dragVect.y * dragVectMag;
+  dragVect.x = -LINEARALG_MUL(dragVect.x, dragVectMag);
+  dragVect.y = -LINEARALG_MUL(dragVect.y, dragVectMag);
 
   // Update the thrust vector. This will only change if the spaceship has
-  // rotated. The thrust vector's direction is contained in
-  // spaceship.vectorArr[0].
-  vector2D_t directVect = linearAlg_normVect(spaceship.vectorArr[FIRST_INDEX],
-                                             spaceship.directVectMag);
+  // rotated. The thrust vector's direction is the heading's unit vector.
+  vector2D_t directVect = orientationDirection[spaceship.heading];
 
   // Multiply component parts by the thrust magnitude to finish updating the
   // thrust vector.
-  spaceship.thrustVect.x = directVect.x * spaceship.thrustVectMag;
-  spaceship.thrustVect.y = directVect.y * spaceship.thrustVectMag;
+  spaceship.thrustVect.x = LINEARALG_MUL(directVect.x, spaceship.thrustVectMag);
+  spaceship.thrustVect.y = LINEARALG_MUL(directVect.y, spaceship.thrustVectMag);
 
   // Add the vectors together to calculate the new velocity vector. Only add the
   // thrust vector components if the bool moveForward is true.
@@ -301,8 +327,7 @@ void translateShip(bool moveForward) {
 // Function to create lasers.
 void fireLaser(bool fire) {
   // Get the normalized vector in the direction the spaceship is facing.
-  vector2D_t laserVelVect = linearAlg_normVect(spaceship.vectorArr[FIRST_INDEX],
-                                               spaceship.directVectMag);
+  vector2D_t laserVelVect = orientationDirection[spaceship.heading];
 
   // Scale directVect by the laser velocity magnitude.
   laserVelVect.x *= LASER_VELOCITY_MAX;
@@ -310,33 +335,50 @@ void fireLaser(bool fire) {
 
   if (fire) {
     laser_addLaser(
-        (int16_t)(spaceship.centerPoint.x + spaceship.vectorArr[FIRST_INDEX].x),
-        (int16_t)(spaceship.centerPoint.y + spaceship.vectorArr[FIRST_INDEX].y),
-        (int8_t)laserVelVect.x, (int8_t)laserVelVect.y);
+        LINEARALG_TO_INT(spaceship.centerPoint.x +
+                         spaceship.vectorArr[FIRST_INDEX].x),
+        LINEARALG_TO_INT(spaceship.centerPoint.y +
+                         spaceship.vectorArr[FIRST_INDEX].y),
+        (int8_t)LINEARALG_TO_INT(laserVelVect.x),
+        (int8_t)LINEARALG_TO_INT(laserVelVect.y));
   }
 }
 
 // Function that handles the movement and firing of the ship.
 void spaceship_moveShip(bool rotateCCW, bool rotateCW, bool moveForward,
                         bool shoot) {
-  // Erase the ship before updating any parameters.
-  drawShip(false);
-
   // Translate the ship if the move forward argument is true. If it is false but
   // it was true in the past the ship should coast for a bit.
+  spaceship.previousCenter = spaceship.centerPoint;
   translateShip(moveForward);
+  spaceship.centerDelta.x =
+      spaceship.centerPoint.x - spaceship.previousCenter.x;
+  spaceship.centerDelta.y =
+      spaceship.centerPoint.y - spaceship.previousCenter.y;
 
   // Code to handle screen wrap.
-  if (spaceship.centerPoint.x <= (-EXTRA_SPACE)) {
-    spaceship.centerPoint.x = SCREEN_WIDTH + EXTRA_SPACE;
-  } else if (spaceship.centerPoint.x >= (SCREEN_WIDTH + EXTRA_SPACE)) {
-    spaceship.centerPoint.x = -EXTRA_SPACE;
+  if (spaceship.centerPoint.x <= LINEARALG_FROM_INT(-EXTRA_SPACE)) {
+    spaceship.centerPoint.x = LINEARALG_FROM_INT(SCREEN_WIDTH + EXTRA_SPACE);
+  } else if (spaceship.centerPoint.x >=
+             LINEARALG_FROM_INT(SCREEN_WIDTH + EXTRA_SPACE)) {
+    spaceship.centerPoint.x = LINEARALG_FROM_INT(-EXTRA_SPACE);
   }
 
-  if (spaceship.centerPoint.y <= (-EXTRA_SPACE)) {
-    spaceship.centerPoint.y = SCREEN_HEIGHT + EXTRA_SPACE;
-  } else if (spaceship.centerPoint.y >= (SCREEN_HEIGHT + EXTRA_SPACE)) {
-    spaceship.centerPoint.y = -EXTRA_SPACE;
+  if (spaceship.centerPoint.y <= LINEARALG_FROM_INT(-EXTRA_SPACE)) {
+    spaceship.centerPoint.y = LINEARALG_FROM_INT(SCREEN_HEIGHT + EXTRA_SPACE);
+  } else if (spaceship.centerPoint.y >=
+             LINEARALG_FROM_INT(SCREEN_HEIGHT + EXTRA_SPACE)) {
+    spaceship.centerPoint.y = LINEARALG_FROM_INT(-EXTRA_SPACE);
+  }
+
+  // Don't interpolate across a wrap.
+  if (spaceship.centerPoint.x - spaceship.previousCenter.x !=
+      spaceship.centerDelta.x) {
+    spaceship.previousCenter.x = spaceship.centerPoint.x;
+  }
+  if (spaceship.centerPoint.y - spaceship.previousCenter.y !=
+      spaceship.centerDelta.y) {
+    spaceship.previousCenter.y = spaceship.centerPoint.y;
   }
 
   // Rotate the ship the appropriate direction if rotateCCW xor rotateCW are
@@ -349,33 +391,53 @@ void spaceship_moveShip(bool rotateCCW, bool rotateCW, bool moveForward,
 
   // Fire lasers.
   fireLaser(shoot);
+}
 
-  // Draw the ship with the new parameters.
-  drawShip(true);
+// Vertices are rounded to whole pixels the way they are drawn, then taken
+// relative to the rounded center. Rounding both can put a vertex up to one
+// more pixel out, which the bounding radius allows for.
+void spaceship_getHull(collision_hull_t *hull) {
+  hull->centerX = LINEARALG_TO_INT(spaceship.centerPoint.x);
+  hull->centerY = LINEARALG_TO_INT(spaceship.centerPoint.y);
+  hull->dx = LINEARALG_TO_INT(spaceship.centerDelta.x);
+  hull->dy = LINEARALG_TO_INT(spaceship.centerDelta.y);
+  hull->boundingRadius = SPACESHIP_BOUNDING_RADIUS + 1;
+  hull->vertexCount = NUM_VERTICIES;
+  for (uint8_t i = 0; i < NUM_VERTICIES; i++) {
+    hull->vertexX[i] =
+        LINEARALG_TO_INT(spaceship.vectorArr[i].x + spaceship.centerPoint.x) -
+        hull->centerX;
+    hull->vertexY[i] =
+        LINEARALG_TO_INT(spaceship.vectorArr[i].y + spaceship.centerPoint.y) -
+        hull->centerY;
+  }
 }
 
-// Return a list of x, y coordinates of the spaceship's centerpoint and
-// verticies.
-void spaceship_getPrinciplePoints(coordinates_t *coordinatesArr) {
-  // Initialize the coordinatesArr using spaceship.vectorArr
-  for (uint8_t i = 0; i < NUM_VERTICIES + 1; i++) {
-    if (i < NUM_VERTICIES) {
-      coordinatesArr[i] = (coordinates_t){
-          .x = (coordMem_t)(spaceship.vectorArr[i].x + spaceship.centerPoint.x),
-          .y =
-              (coordMem_t)(spaceship.vectorArr[i].y + spaceship.centerPoint.y)};
-    } else { // Append the centerpoint at the end.
-      coordinatesArr[i] =
-          (coordinates_t){.x = (coordMem_t)spaceship.centerPoint.x,
-                          .y = (coordMem_t)spaceship.centerPoint.y};
-    }
+// Fold the spaceship state into hash. The vertices follow from heading.
+uint32_t spaceship_hashState(uint32_t hash) {
+  hash = stateHash_add(hash, &currentState, sizeof currentState);
+  hash = stateHash_add(hash, &enabled, sizeof enabled);
+  hash = stateHash_add(hash, &laserCooldown, sizeof laserCooldown);
+  hash = stateHash_add(hash, &spaceship.heading, sizeof spaceship.heading);
+  hash = stateHash_add(hash, &spaceship.centerPoint.x,
+                       sizeof spaceship.centerPoint.x);
+  hash = stateHash_add(hash, &spaceship.centerPoint.y,
+                       sizeof spaceship.centerPoint.y);
+  hash = stateHash_add(hash, &spaceship.velocityVect.x,
+                       sizeof spaceship.velocityVect.x);
+  return stateHash_add(hash, &spaceship.velocityVect.y,
+                       sizeof spaceship.velocityVect.y);
+}
+
+// Submit the ship to the render stage while it is in play.
+void spaceship_draw(uint16_t alpha) {
+  if (enabled && currentState == play_st) {
+    drawShip(alpha);
   }
 }
 
 // Standard tick function for spaceship.
 void spaceship_tick() {
-  static uint8_t laserCooldown = 0;
-
   if (enabled) {
     // asteroid_debugState();
   }
@@ -389,16 +451,16 @@ void spaceship_tick() {
     break;
   case play_st:
     if (!enabled) {
-      drawShip(false);
       currentState = init_st;
     } else {
       bool fire = false;
       bool thrust = false;
       bool turnLeft = false;
       bool turnRight = false;
-      if ((buttons_read() & FIRE_BTN3_MASK) && (laserCooldown == 0)) {
+      uint8_t buttons = input_getHeld();
+      if ((buttons & FIRE_BTN3_MASK) && (laserCooldown == 0)) {
         laserCooldown++;
-        printf("FIRE BUTTON\n");
+        LOG_DEBUG(logger_fireButton, 0, 0);
         fire = true;
       }
 
@@ -410,18 +472,17 @@ void spaceship_tick() {
         laserCooldown = 0;
       }
 
-      if (buttons_read() & THRUST_BTN1_MASK) {
-        printf("THRUST BUTTON\n");
+      if (buttons & THRUST_BTN1_MASK) {
+        LOG_DEBUG(logger_thrustButton, 0, 0);
         thrust = true;
       }
-      if ((buttons_read() & LEFT_BTN0_MASK) &&
-          (buttons_read() & RIGHT_BTN2_MASK)) {
-        printf("LEFT AND RIGHT BUTTONS\n");
-      } else if (buttons_read() & LEFT_BTN0_MASK) {
-        printf("LEFT BUTTON\n");
+      if ((buttons & LEFT_BTN0_MASK) && (buttons & RIGHT_BTN2_MASK)) {
+        LOG_DEBUG(logger_leftAndRightButtons, 0, 0);
+      } else if (buttons & LEFT_BTN0_MASK) {
+        LOG_DEBUG(logger_leftButton, 0, 0);
         turnLeft = true;
-      } else if (buttons_read() & RIGHT_BTN2_MASK) {
-        printf("RIGHT BUTTON\n");
+      } else if (buttons & RIGHT_BTN2_MASK) {
+        LOG_DEBUG(logger_rightButton, 0, 0);
         turnRight = true;
       }
       spaceship_moveShip(turnLeft, turnRight, thrust, fire);
@@ -440,7 +501,4 @@ void spaceship_enable() {
 }
 
 // Disable Spaceship.
-void spaceship_disable() {
-  drawShip(false);
-  enabled = false;
-}
\ No newline at end of file
+void spaceship_disable() { enabled = false; }
\ No newline at end of file
@@ -1,21 +1,16 @@
 #ifndef SPACESHIP_H_
 #define SPACESHIP_H_
 
+#include "collision.h"
 #include <stdbool.h>
 #include <stdint.h>
 
 // Definitions for the positioning of the verticies of the spaceship.
 #define NUM_VERTICIES 5
 
-// Define a new type for the coordinate struct members.
-typedef uint16_t coordMem_t;
-
-// Define a struct to hold x, y, coordinates as integers for the LCD screen and
-// collision detection.
-typedef struct {
-  coordMem_t x;
-  coordMem_t y;
-} coordinates_t;
+// Distance from the center point to the farthest vertex, rounded up. Every
+// part of the ship is inside this circle whatever its heading.
+#define SPACESHIP_BOUNDING_RADIUS 13
 
 // Initialize the spaceship with starting values.
 void spaceship_init();
@@ -27,9 +22,17 @@ void spaceship_runTest(bool rotateCCW, bool fireRockets);
 void spaceship_moveShip(bool rotateCCW, bool rotateCW, bool moveForward,
                         bool shoot);
 
-// Populate an array of x, y coordinates of the spaceship's centerpoint and
-// verticies.
-void spaceship_getPrinciplePoints(coordinates_t *coordinatesArr);
+// Fill hull with the ship's outline where it is now, in whole pixels, and how
+// far its center moved during the last tick (before any screen wrap), so
+// collisions can be swept along the ship's path.
+void spaceship_getHull(collision_hull_t *hull);
+
+// Fold the spaceship state into hash (see stateHash.h) and return the result.
+uint32_t spaceship_hashState(uint32_t hash);
+
+// Submit the ship to the render stage, its center drawn alpha of the way
+// (see RENDER_ALPHA_ONE) through the last tick's move. Call once per frame.
+void spaceship_draw(uint16_t alpha);
 
 // Standard Tick Function for spaceship.
 void spaceship_tick();
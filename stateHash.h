@@ -0,0 +1,23 @@
+#ifndef STATEHASH_H_
+#define STATEHASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 32-bit FNV-1a, used to fingerprint the game state once per tick so a
+// replay can tell the moment it stops matching the recorded session. Start
+// from STATEHASH_INIT and feed each field in turn; feed fields rather than
+// whole structs so padding bytes stay out of the hash.
+#define STATEHASH_INIT 2166136261u
+#define STATEHASH_PRIME 16777619u
+
+static inline uint32_t stateHash_add(uint32_t hash, const void *data,
+                                     size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * STATEHASH_PRIME;
+  }
+  return hash;
+}
+
+#endif /* STATEHASH_H_ */
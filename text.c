@@ -0,0 +1,58 @@
+#include "text.h"
+#include "font.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GLYPH_COUNT (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1)
+
+// Every printable glyph at every cached size, filled in on first use.
+static text_glyph_t glyphCache[TEXT_MAX_SIZE][GLYPH_COUNT];
+static bool glyphCached[TEXT_MAX_SIZE][GLYPH_COUNT];
+
+// Widen the font's column bytes into row masks at size.
+static void text_rasterize(char c, uint8_t size, text_glyph_t *glyph) {
+  const uint8_t *columns = font_getGlyph(c);
+  uint32_t cell = (1u << size) - 1; // size set bits.
+  for (uint8_t row = 0; row < FONT_GLYPH_ROWS; row++) {
+    uint32_t mask = 0;
+    for (uint8_t col = 0; col < FONT_GLYPH_COLUMNS; col++) {
+      if (columns[col] & (1 << row)) {
+        mask |= cell << (col * size);
+      }
+    }
+    glyph->rows[row] = mask;
+  }
+}
+
+// The glyph for c at size, rasterizing it on first use. Characters outside
+// the font come back blank like font_getGlyph; sizes past TEXT_MAX_SIZE are
+// clamped.
+const text_glyph_t *text_getGlyph(char c, uint8_t size) {
+  if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+    c = ' ';
+  }
+  size = size < 1 ? 1 : size > TEXT_MAX_SIZE ? TEXT_MAX_SIZE : size;
+  uint8_t index = c - FONT_FIRST_CHAR;
+  text_glyph_t *glyph = &glyphCache[size - 1][index];
+  if (!glyphCached[size - 1][index]) {
+    text_rasterize(c, size, glyph);
+    glyphCached[size - 1][index] = true;
+  }
+  return glyph;
+}
+
+// Write value in decimal, filling a buffer from the right and copying it to
+// the front.
+uint8_t text_formatUnsigned(uint32_t value, char *str) {
+  char digits[TEXT_MAX_DIGITS];
+  uint8_t count = 0;
+  do {
+    digits[TEXT_MAX_DIGITS - 1 - count++] = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+  for (uint8_t i = 0; i < count; i++) {
+    str[i] = digits[TEXT_MAX_DIGITS - count + i];
+  }
+  str[count] = '\0';
+  return count;
+}
@@ -0,0 +1,31 @@
+#ifndef TEXT_H_
+#define TEXT_H_
+
+#include "font.h"
+#include <stdint.h>
+
+// Largest text size with cached glyphs. A glyph row at size s is
+// DISPLAY_CHAR_WIDTH * s bits wide and has to fit in 32.
+#define TEXT_MAX_SIZE 5
+
+// Longest string text_formatUnsigned can produce, not counting the
+// terminator.
+#define TEXT_MAX_DIGITS 10
+
+// A glyph rasterized at one text size: one mask per font row, already
+// widened to the size, with bit 0 the leftmost pixel. Each row is drawn size
+// pixels tall.
+typedef struct {
+  uint32_t rows[FONT_GLYPH_ROWS];
+} text_glyph_t;
+
+// The glyph for c at size (1 to TEXT_MAX_SIZE). Each glyph is rasterized the
+// first time it is asked for and kept, so text that is drawn again, like the
+// HUD digits, costs a table lookup.
+const text_glyph_t *text_getGlyph(char c, uint8_t size);
+
+// Write value in decimal to str, which must hold TEXT_MAX_DIGITS + 1 chars,
+// and return its length. No stdio, no allocation.
+uint8_t text_formatUnsigned(uint32_t value, char *str);
+
+#endif /* TEXT_H_ */